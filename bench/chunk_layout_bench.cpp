@@ -0,0 +1,141 @@
+// Compares the Linear_Layout and Morton_Layout chunk layouts on meshing and flood-fill workloads.
+// Build with -DMINECRAFTPP_BUILD_BENCHMARKS=ON and run chunk_layout_bench.
+
+#include <chunk.hpp>
+#include <chunk_layout.hpp>
+#include <mesher.hpp>
+#include <types.hpp>
+
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace minecraftpp {
+    constexpr i32 world_size = 4;
+    constexpr i32 chunk_count = world_size * world_size * world_size;
+    constexpr i32 iterations = 20;
+
+    // Rolling hills with random caves, so that chunks hold a mix of uniform, surface and cave sections.
+    Block_Type generate_block(i32 const x, i32 const y, i32 const z, std::mt19937& random) {
+        f64 const height = 32.0 + 12.0 * std::sin(x * 0.07) * std::cos(z * 0.05) + 6.0 * std::sin((x + z) * 0.13);
+        if(y > height) {
+            return Block_Type::air;
+        }
+
+        return random() % 8 == 0 ? Block_Type::air : Block_Type::dirt;
+    }
+
+    template<typename Layout>
+    std::vector<Basic_Chunk<Layout>> generate_chunks() {
+        std::vector<Basic_Chunk<Layout>> chunks(chunk_count);
+        std::mt19937 random{42};
+        for(i32 i = 0; i < chunk_count; ++i) {
+            Basic_Chunk<Layout>& chunk = chunks[i];
+            chunk.coordinates = {i % world_size, i / world_size % world_size, i / (world_size * world_size)};
+            for(i32 z = 0; z < 16; ++z) {
+                for(i32 y = 0; y < 16; ++y) {
+                    for(i32 x = 0; x < 16; ++x) {
+                        Block_Type const block = generate_block(chunk.coordinates.x * 16 + x, chunk.coordinates.y * 16 + y, chunk.coordinates.z * 16 + z, random);
+                        chunk.set_block(x, y, z, block);
+                    }
+                }
+            }
+        }
+        return chunks;
+    }
+
+    template<typename Layout>
+    usize mesh_all(std::vector<Basic_Chunk<Layout>> const& chunks) {
+        usize quads = 0;
+        for(i32 i = 0; i < chunk_count; ++i) {
+            Basic_Chunk_Neighbourhood<Layout> neighbourhood{chunks[i], {}};
+            glm::ivec3 const coordinates = chunks[i].coordinates;
+            for(i32 face = 0; face < 6; ++face) {
+                auto const [dx, dy, dz] = face_directions[face];
+                glm::ivec3 const neighbour{coordinates.x + dx, coordinates.y + dy, coordinates.z + dz};
+                bool const inside = neighbour.x >= 0 && neighbour.x < world_size && neighbour.y >= 0 && neighbour.y < world_size && neighbour.z >= 0 &&
+                                    neighbour.z < world_size;
+                if(inside) {
+                    neighbourhood.neighbours[face] = &chunks[neighbour.x + neighbour.y * world_size + neighbour.z * world_size * world_size];
+                }
+            }
+            quads += build_mesh(neighbourhood).quads.size();
+        }
+        return quads;
+    }
+
+    // Breadth-first fill over the transparent blocks of a chunk starting from its top layer, the
+    // access pattern of sky light propagation and cave visibility.
+    template<typename Layout>
+    usize flood_fill(Basic_Chunk<Layout> const& chunk) {
+        std::bitset<4096> visited;
+        std::vector<u16> queue;
+        queue.reserve(4096);
+        for(i32 z = 0; z < 16; ++z) {
+            for(i32 x = 0; x < 16; ++x) {
+                if(!is_opaque(chunk.block_at(x, 15, z))) {
+                    i32 const index = Layout::index(x, 15, z);
+                    visited[index] = true;
+                    queue.push_back(index);
+                }
+            }
+        }
+
+        for(usize head = 0; head < queue.size(); ++head) {
+            auto const [x, y, z] = Layout::position(queue[head]);
+            for(auto const [dx, dy, dz] : face_directions) {
+                i32 const nx = x + dx;
+                i32 const ny = y + dy;
+                i32 const nz = z + dz;
+                if(nx < 0 || nx > 15 || ny < 0 || ny > 15 || nz < 0 || nz > 15) {
+                    continue;
+                }
+
+                i32 const index = Layout::index(nx, ny, nz);
+                if(!visited[index] && !is_opaque(chunk.block_at(nx, ny, nz))) {
+                    visited[index] = true;
+                    queue.push_back(index);
+                }
+            }
+        }
+        return queue.size();
+    }
+
+    template<typename F>
+    f64 time_per_chunk_us(F&& workload, usize& checksum) {
+        auto const start = std::chrono::steady_clock::now();
+        for(i32 i = 0; i < iterations; ++i) {
+            checksum += workload();
+        }
+        auto const end = std::chrono::steady_clock::now();
+        return std::chrono::duration<f64, std::micro>(end - start).count() / (iterations * chunk_count);
+    }
+
+    template<typename Layout>
+    void run_benchmark(char const* const name) {
+        std::vector<Basic_Chunk<Layout>> const chunks = generate_chunks<Layout>();
+        usize checksum = 0;
+        f64 const meshing = time_per_chunk_us([&] { return mesh_all(chunks); }, checksum);
+        f64 const filling = time_per_chunk_us(
+            [&] {
+                usize filled = 0;
+                for(auto const& chunk : chunks) {
+                    filled += flood_fill(chunk);
+                }
+                return filled;
+            },
+            checksum);
+        std::printf("%-8s meshing: %8.2f us/chunk, flood fill: %8.2f us/chunk (checksum %llu)\n", name, meshing, filling, checksum);
+    }
+}
+
+int main() {
+    using namespace minecraftpp;
+    run_benchmark<Linear_Layout>("linear");
+    run_benchmark<Morton_Layout>("morton");
+    return 0;
+}
@@ -0,0 +1,349 @@
+#ifndef MINECRAFTPP_BLOCK_COMPRESSION_HPP
+#define MINECRAFTPP_BLOCK_COMPRESSION_HPP
+
+#include <types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define MINECRAFTPP_BLOCK_COMPRESSION_SSE2
+#endif
+
+// Encoders for the BC1 (S3TC DXT1), BC3 (S3TC DXT5) and BC7 (BPTC) block-compressed texture formats. Each
+// compresses a square RGBA8 image in blocks of 4x4 texels. Endpoints are fitted along the principal axis
+// of the block, which is quick and good enough for textures with few colors per block. Indices pick the
+// closest color of the block palette.
+namespace minecraftpp {
+    // A block of 4x4 texels in row-major order, channel by channel with values from 0 to 255.
+    struct Texel_Block {
+        alignas(16) f32 channels[4][16];
+    };
+
+    // Reads the block at block_x, block_y of a size x size RGBA8 image. Texels past the edge of images
+    // smaller than a block repeat the edge.
+    inline Texel_Block load_texel_block(u8 const* const image, i32 const size, i32 const block_x, i32 const block_y) {
+        Texel_Block block;
+        for(i32 i = 0; i < 16; ++i) {
+            i32 const x = std::min(block_x * 4 + i % 4, size - 1);
+            i32 const y = std::min(block_y * 4 + i / 4, size - 1);
+            for(i32 channel = 0; channel < 4; ++channel) {
+                block.channels[channel][i] = image[(y * size + x) * 4 + channel];
+            }
+        }
+        return block;
+    }
+
+    // Ends of the segment covering the texels along their principal axis, in the first channel_count channels.
+    inline void fit_endpoints(Texel_Block const& block, i32 const channel_count, f32 (&low)[4], f32 (&high)[4]) {
+        f32 mean[4] = {};
+        for(i32 channel = 0; channel < channel_count; ++channel) {
+            for(i32 i = 0; i < 16; ++i) {
+                mean[channel] += block.channels[channel][i];
+            }
+            mean[channel] /= 16;
+        }
+
+        f32 covariance[4][4] = {};
+        for(i32 i = 0; i < 16; ++i) {
+            for(i32 a = 0; a < channel_count; ++a) {
+                for(i32 b = 0; b < channel_count; ++b) {
+                    covariance[a][b] += (block.channels[a][i] - mean[a]) * (block.channels[b][i] - mean[b]);
+                }
+            }
+        }
+
+        // Power iteration, starting from the channel that varies most.
+        i32 widest = 0;
+        for(i32 channel = 1; channel < channel_count; ++channel) {
+            if(covariance[channel][channel] > covariance[widest][widest]) {
+                widest = channel;
+            }
+        }
+        f32 axis[4] = {};
+        std::copy(covariance[widest], covariance[widest] + channel_count, axis);
+        for(i32 iteration = 0; iteration < 8; ++iteration) {
+            f32 next[4] = {};
+            f32 largest = 0;
+            for(i32 a = 0; a < channel_count; ++a) {
+                for(i32 b = 0; b < channel_count; ++b) {
+                    next[a] += covariance[a][b] * axis[b];
+                }
+                largest = std::max(largest, std::abs(next[a]));
+            }
+            if(largest == 0) {
+                break;
+            }
+            for(i32 a = 0; a < channel_count; ++a) {
+                axis[a] = next[a] / largest;
+            }
+        }
+
+        f32 length = 0;
+        for(i32 channel = 0; channel < channel_count; ++channel) {
+            length += axis[channel] * axis[channel];
+        }
+        length = std::sqrt(length);
+        f32 minimum = 0;
+        f32 maximum = 0;
+        if(length > 0) {
+            for(i32 channel = 0; channel < channel_count; ++channel) {
+                axis[channel] /= length;
+            }
+            for(i32 i = 0; i < 16; ++i) {
+                f32 t = 0;
+                for(i32 channel = 0; channel < channel_count; ++channel) {
+                    t += (block.channels[channel][i] - mean[channel]) * axis[channel];
+                }
+                minimum = std::min(minimum, t);
+                maximum = std::max(maximum, t);
+            }
+        }
+
+        for(i32 channel = 0; channel < 4; ++channel) {
+            low[channel] = std::clamp(mean[channel] + minimum * axis[channel], 0.0f, 255.0f);
+            high[channel] = std::clamp(mean[channel] + maximum * axis[channel], 0.0f, 255.0f);
+        }
+    }
+
+    // Index of the palette entry closest to each texel, comparing the channels from first_channel up to
+    // channel_end. The palette is given channel by channel.
+    template<usize palette_size>
+    std::array<u8, 16> nearest_indices(Texel_Block const& block, f32 const (&palette)[4][palette_size], i32 const first_channel,
+                                       i32 const channel_end) {
+        static_assert(palette_size % 4 == 0, "the palette has to fill whole vectors");
+
+        std::array<u8, 16> indices;
+#if defined(MINECRAFTPP_BLOCK_COMPRESSION_SSE2)
+        constexpr usize group_count = palette_size / 4;
+        for(i32 i = 0; i < 16; ++i) {
+            __m128 distances[group_count];
+            for(usize group = 0; group < group_count; ++group) {
+                distances[group] = _mm_setzero_ps();
+            }
+            for(i32 channel = first_channel; channel < channel_end; ++channel) {
+                __m128 const texel = _mm_set1_ps(block.channels[channel][i]);
+                for(usize group = 0; group < group_count; ++group) {
+                    __m128 const difference = _mm_sub_ps(_mm_loadu_ps(&palette[channel][group * 4]), texel);
+                    distances[group] = _mm_add_ps(distances[group], _mm_mul_ps(difference, difference));
+                }
+            }
+
+            // Broadcast the smallest distance to all lanes and take the first entry that has it.
+            __m128 closest = distances[0];
+            for(usize group = 1; group < group_count; ++group) {
+                closest = _mm_min_ps(closest, distances[group]);
+            }
+            closest = _mm_min_ps(closest, _mm_shuffle_ps(closest, closest, _MM_SHUFFLE(1, 0, 3, 2)));
+            closest = _mm_min_ps(closest, _mm_shuffle_ps(closest, closest, _MM_SHUFFLE(2, 3, 0, 1)));
+            u32 matches = 0;
+            for(usize group = 0; group < group_count; ++group) {
+                matches |= static_cast<u32>(_mm_movemask_ps(_mm_cmpeq_ps(distances[group], closest))) << (group * 4);
+            }
+            indices[i] = static_cast<u8>(std::countr_zero(matches));
+        }
+#else
+        for(i32 i = 0; i < 16; ++i) {
+            f32 closest = INFINITY;
+            for(usize entry = 0; entry < palette_size; ++entry) {
+                f32 distance = 0;
+                for(i32 channel = first_channel; channel < channel_end; ++channel) {
+                    f32 const difference = palette[channel][entry] - block.channels[channel][i];
+                    distance += difference * difference;
+                }
+                if(distance < closest) {
+                    closest = distance;
+                    indices[i] = static_cast<u8>(entry);
+                }
+            }
+        }
+#endif
+        return indices;
+    }
+
+    // Writes the low count bytes of value in little-endian order.
+    inline u8* write_little_endian(u8* destination, u64 value, i32 const count) {
+        for(i32 i = 0; i < count; ++i, value >>= 8) {
+            *destination++ = static_cast<u8>(value);
+        }
+        return destination;
+    }
+
+    // 8-byte color block of BC1, also used by BC3. Always uses the four color mode, so it carries no alpha.
+    inline void encode_color_block(Texel_Block const& block, u8* const destination) {
+        f32 low[4], high[4];
+        fit_endpoints(block, 3, low, high);
+        auto const to_565 = [](f32 const (&color)[4]) {
+            u32 const r = static_cast<u32>(std::lround(color[0] * 31 / 255));
+            u32 const g = static_cast<u32>(std::lround(color[1] * 63 / 255));
+            u32 const b = static_cast<u32>(std::lround(color[2] * 31 / 255));
+            return static_cast<u16>(r << 11 | g << 5 | b);
+        };
+        u16 first = to_565(high);
+        u16 second = to_565(low);
+        if(first < second) {
+            std::swap(first, second);
+        }
+
+        // With equal endpoints every index selects the first one.
+        u32 index_bits = 0;
+        if(first != second) {
+            f32 palette[4][4] = {};
+            u16 const endpoints[2] = {first, second};
+            for(i32 end = 0; end < 2; ++end) {
+                u32 const r = endpoints[end] >> 11;
+                u32 const g = endpoints[end] >> 5 & 0x3F;
+                u32 const b = endpoints[end] & 0x1F;
+                palette[0][end] = static_cast<f32>(r << 3 | r >> 2);
+                palette[1][end] = static_cast<f32>(g << 2 | g >> 4);
+                palette[2][end] = static_cast<f32>(b << 3 | b >> 2);
+            }
+            for(i32 channel = 0; channel < 3; ++channel) {
+                palette[channel][2] = (2 * palette[channel][0] + palette[channel][1]) / 3;
+                palette[channel][3] = (palette[channel][0] + 2 * palette[channel][1]) / 3;
+            }
+
+            std::array<u8, 16> const indices = nearest_indices(block, palette, 0, 3);
+            for(i32 i = 0; i < 16; ++i) {
+                index_bits |= static_cast<u32>(indices[i]) << (2 * i);
+            }
+        }
+
+        u8* output = write_little_endian(destination, first, 2);
+        output = write_little_endian(output, second, 2);
+        write_little_endian(output, index_bits, 4);
+    }
+
+    // 8-byte alpha block of BC3 in the mode with six interpolated values.
+    inline void encode_alpha_block(Texel_Block const& block, u8* const destination) {
+        auto const [lowest, highest] = std::minmax_element(block.channels[3], block.channels[3] + 16);
+        u8 const first = static_cast<u8>(std::lround(*highest));
+        u8 const second = static_cast<u8>(std::lround(*lowest));
+
+        u64 index_bits = 0;
+        if(first > second) {
+            f32 palette[4][8] = {};
+            palette[3][0] = first;
+            palette[3][1] = second;
+            for(i32 entry = 2; entry < 8; ++entry) {
+                palette[3][entry] = static_cast<f32>(((8 - entry) * first + (entry - 1) * second) / 7);
+            }
+
+            std::array<u8, 16> const indices = nearest_indices(block, palette, 3, 4);
+            for(i32 i = 0; i < 16; ++i) {
+                index_bits |= static_cast<u64>(indices[i]) << (3 * i);
+            }
+        }
+
+        destination[0] = first;
+        destination[1] = second;
+        write_little_endian(destination + 2, index_bits, 6);
+    }
+
+    // 16-byte BC7 block in mode 6: one subset, RGBA endpoints of 7 bits plus a shared lowest bit each and
+    // 4-bit indices, which suits blocks that hold a single gradient.
+    inline void encode_bc7_block(Texel_Block const& block, u8* const destination) {
+        f32 ends[2][4];
+        fit_endpoints(block, 4, ends[0], ends[1]);
+
+        // Quantize each endpoint with the lowest bit that loses the least.
+        u32 quantized[2][4];
+        u32 low_bits[2];
+        f32 palette[4][16];
+        for(i32 end = 0; end < 2; ++end) {
+            f32 best_error = INFINITY;
+            for(u32 low_bit = 0; low_bit < 2; ++low_bit) {
+                u32 candidate[4];
+                f32 error = 0;
+                for(i32 channel = 0; channel < 4; ++channel) {
+                    candidate[channel] = static_cast<u32>(std::clamp(std::lround((ends[end][channel] - low_bit) / 2), 0l, 127l));
+                    f32 const difference = static_cast<f32>(candidate[channel] * 2 + low_bit) - ends[end][channel];
+                    error += difference * difference;
+                }
+                if(error < best_error) {
+                    best_error = error;
+                    low_bits[end] = low_bit;
+                    std::copy(candidate, candidate + 4, quantized[end]);
+                }
+            }
+        }
+
+        constexpr std::array<u32, 16> weights{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+        for(i32 channel = 0; channel < 4; ++channel) {
+            u32 const first = quantized[0][channel] * 2 + low_bits[0];
+            u32 const second = quantized[1][channel] * 2 + low_bits[1];
+            for(usize entry = 0; entry < 16; ++entry) {
+                palette[channel][entry] = static_cast<f32>(((64 - weights[entry]) * first + weights[entry] * second + 32) >> 6);
+            }
+        }
+        std::array<u8, 16> indices = nearest_indices(block, palette, 0, 4);
+
+        // The highest index bit of the first texel is implied to be 0, so swap the endpoints when it is set.
+        if(indices[0] >= 8) {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(low_bits[0], low_bits[1]);
+            for(u8& index : indices) {
+                index = 15 - index;
+            }
+        }
+
+        // Fields are packed from the lowest bit up.
+        u64 words[2] = {};
+        i32 position = 0;
+        auto const write = [&](u64 const value, i32 const count) {
+            for(i32 bit = 0; bit < count; ++bit, ++position) {
+                words[position / 64] |= (value >> bit & 1) << (position % 64);
+            }
+        };
+        write(1 << 6, 7);
+        for(i32 channel = 0; channel < 4; ++channel) {
+            write(quantized[0][channel], 7);
+            write(quantized[1][channel], 7);
+        }
+        write(low_bits[0], 1);
+        write(low_bits[1], 1);
+        write(indices[0], 3);
+        for(i32 i = 1; i < 16; ++i) {
+            write(indices[i], 4);
+        }
+
+        write_little_endian(write_little_endian(destination, words[0], 8), words[1], 8);
+    }
+
+    // Compresses a size x size RGBA8 image block by block. Images smaller than a block take one block.
+    template<typename Encode>
+    std::vector<u8> compress_blocks(u8 const* const image, i32 const size, usize const block_bytes, Encode const encode) {
+        i32 const blocks_across = (size + 3) / 4;
+        std::vector<u8> compressed(static_cast<usize>(blocks_across) * blocks_across * block_bytes);
+        u8* output = compressed.data();
+        for(i32 block_y = 0; block_y < blocks_across; ++block_y) {
+            for(i32 block_x = 0; block_x < blocks_across; ++block_x) {
+                encode(load_texel_block(image, size, block_x, block_y), output);
+                output += block_bytes;
+            }
+        }
+        return compressed;
+    }
+
+    // Opaque images only, alpha is dropped.
+    inline std::vector<u8> compress_bc1(u8 const* const image, i32 const size) {
+        return compress_blocks(image, size, 8, encode_color_block);
+    }
+
+    inline std::vector<u8> compress_bc3(u8 const* const image, i32 const size) {
+        return compress_blocks(image, size, 16, [](Texel_Block const& block, u8* const destination) {
+            encode_alpha_block(block, destination);
+            encode_color_block(block, destination + 8);
+        });
+    }
+
+    inline std::vector<u8> compress_bc7(u8 const* const image, i32 const size) {
+        return compress_blocks(image, size, 16, encode_bc7_block);
+    }
+}
+
+#endif // !MINECRAFTPP_BLOCK_COMPRESSION_HPP
@@ -0,0 +1,313 @@
+#ifndef MINECRAFTPP_BLOCK_TEXTURES_HPP
+#define MINECRAFTPP_BLOCK_TEXTURES_HPP
+
+#include <chunk.hpp>
+#include <texture_cache.hpp>
+#include <thread_pool.hpp>
+#include <types.hpp>
+
+#include "glad/glad.h"
+#include "stb/stb_image.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Not part of core OpenGL, so glad leaves them out.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+    #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace minecraftpp {
+    // Image file of every layer of the block texture array, indexed by Block_Texture.
+    inline constexpr std::array<char const*, 4> block_texture_files{
+        "textures/dirt.jpg",
+        "textures/grass_top.png",
+        "textures/grass_side.png",
+        "textures/grass_bottom.png",
+    };
+
+    static_assert(block_texture_files.size() == static_cast<usize>(Block_Texture::grass_bottom) + 1,
+                  "every Block_Texture needs a file");
+
+    // Cooked copy of the block texture array with all of its mip levels, written on the first run.
+    inline constexpr char const* block_texture_cache_file = "cache/block_textures.mctx";
+
+    // All block face textures in a single GL_TEXTURE_2D_ARRAY with a full mip chain, one layer per
+    // Block_Texture. Chunk quads carry their layer, so every block type renders in the same draw.
+    //
+    // Layers of an array share one size, so smaller images are scaled up to the largest one with
+    // nearest filtering, which keeps pixel art sharp. Sizes have to be powers of two.
+    //
+    // Only the image headers are read up front. The images are decoded and scaled by the thread pool
+    // straight into a persistently mapped pixel buffer, and update() copies each finished layer from
+    // there into the array on the GPU. Until then a layer shows a flat grey placeholder, so the first
+    // frames do not wait for image decoding.
+    //
+    // Once every layer is in, the workers cook the array into block_texture_cache_file, block-compressed
+    // to BC7, which is core since OpenGL 4.2. Define MINECRAFTPP_S3TC_BLOCK_TEXTURES to use BC1, or BC3 when
+    // some texel is translucent, on drivers with EXT_texture_compression_s3tc instead. Later runs map the
+    // file and upload all levels straight from it, and only go back to the images when they have changed.
+    class Block_Texture_Array {
+    public:
+        explicit Block_Texture_Array(Thread_Pool& workers): workers(workers) {
+            source_stamp = texture_source_stamp(block_texture_files);
+            if(load_cooked()) {
+                return;
+            }
+
+            std::array<i32, block_texture_files.size()> sizes;
+            for(usize layer = 0; layer < block_texture_files.size(); ++layer) {
+                i32 width, height, components;
+                if(!stbi_info(block_texture_files[layer], &width, &height, &components) || width != height ||
+                   !std::has_single_bit(static_cast<u32>(width))) {
+                    std::cout << "[Error] block texture " << block_texture_files[layer] << " failed to load or is not a square power of two\n";
+                    throw std::runtime_error("block texture loading failed");
+                }
+                sizes[layer] = width;
+            }
+
+            size = *std::max_element(sizes.begin(), sizes.end());
+            i32 const levels = std::bit_width(static_cast<u32>(size));
+            create_texture(levels, GL_RGBA8);
+            std::array<u8, 4> const placeholder{128, 128, 128, 255};
+            for(i32 level = 0; level < levels; ++level) {
+                glClearTexImage(id, level, GL_RGBA, GL_UNSIGNED_BYTE, placeholder.data());
+            }
+
+            // Every layer gets its own part of the pixel buffer, so the workers and the copies never share memory.
+            GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glCreateBuffers(1, &pixel_buffer);
+            glNamedBufferStorage(pixel_buffer, layer_count * layer_bytes(), nullptr, flags);
+            u8* const mapping = static_cast<u8*>(glMapNamedBufferRange(pixel_buffer, 0, layer_count * layer_bytes(), flags));
+            for(usize layer = 0; layer < layer_count; ++layer) {
+                decoded[layer] = workers.submit([path = block_texture_files[layer], source_size = sizes[layer], size = size,
+                                                 image = &images[layer], destination = mapping + layer * layer_bytes()] {
+                    decode(path, source_size, size, *image);
+                    std::copy(image->begin(), image->end(), destination);
+                });
+            }
+        }
+
+        Block_Texture_Array(Block_Texture_Array const&) = delete;
+        Block_Texture_Array& operator=(Block_Texture_Array const&) = delete;
+
+        ~Block_Texture_Array() {
+            // The workers write into the pixel buffer, so it has to outlive them.
+            for(std::future<void>& layer : decoded) {
+                if(layer.valid()) {
+                    layer.wait();
+                }
+            }
+            release_pixel_buffer();
+            glDeleteTextures(1, &id);
+        }
+
+        // Copies the layers decoded since the last call into the array. Called once per frame. Rethrows
+        // the errors of failed decodes.
+        void update() {
+            if(pixel_buffer == 0) {
+                return;
+            }
+
+            bool changed = false;
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer);
+            for(usize layer = 0; layer < layer_count; ++layer) {
+                if(!decoded[layer].valid() || decoded[layer].wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                    continue;
+                }
+
+                decoded[layer].get();
+                void const* const offset = reinterpret_cast<void const*>(layer * layer_bytes());
+                glTextureSubImage3D(id, 0, 0, 0, static_cast<i32>(layer), size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE, offset);
+                ++uploaded_count;
+                changed = true;
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            if(changed) {
+                glGenerateTextureMipmap(id);
+            }
+            if(uploaded_count == layer_count) {
+                // Pending copies keep the buffer alive until they are done.
+                release_pixel_buffer();
+                cook();
+            }
+        }
+
+        // Whether every layer holds its texture instead of the placeholder.
+        bool is_loaded() const {
+            return uploaded_count == layer_count;
+        }
+
+        u32 get_id() const {
+            return id;
+        }
+
+    private:
+        static constexpr usize layer_count = block_texture_files.size();
+
+        Thread_Pool& workers;
+        u64 source_stamp = 0;
+        u32 id = 0;
+        i32 size = 0;
+        u32 pixel_buffer = 0;
+        // Decoded layers, kept on the CPU for cooking.
+        std::array<std::vector<u8>, layer_count> images;
+        std::array<std::future<void>, layer_count> decoded;
+        usize uploaded_count = 0;
+
+        usize layer_bytes() const {
+            return static_cast<usize>(size) * size * 4;
+        }
+
+        void create_texture(i32 const levels, GLenum const internal_format) {
+            glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &id);
+            glTextureStorage3D(id, levels, internal_format, size, size, static_cast<i32>(layer_count));
+            glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+
+        // Uploads every level of the cooked array if the cache file is up to date. Returns false otherwise.
+        bool load_cooked() {
+            std::optional<Cooked_Texture> const cooked = Cooked_Texture::open(block_texture_cache_file, source_stamp);
+            if(!cooked || cooked->get_header().layer_count != static_cast<i32>(layer_count) || !is_supported(cooked->get_header().format)) {
+                return false;
+            }
+
+            Cooked_Texture_Header const& header = cooked->get_header();
+            size = header.size;
+            GLenum const internal_format = get_internal_format(header.format);
+            create_texture(header.level_count, internal_format);
+            for(i32 level = 0; level < header.level_count; ++level) {
+                i32 const level_size = std::max(size >> level, 1);
+                usize const bytes = cooked_level_bytes(header.format, size, level) * layer_count;
+                glCompressedTextureSubImage3D(id, level, 0, 0, 0, level_size, level_size, static_cast<i32>(layer_count), internal_format,
+                                              static_cast<i32>(bytes), cooked->level_data(level));
+            }
+            uploaded_count = layer_count;
+            return true;
+        }
+
+        // Compresses every decoded layer on its own worker and writes the result to the cache file. A failure
+        // only costs the next run its head start.
+        void cook() {
+            Cooked_Format const format = choose_format();
+            std::array<std::future<Cooked_Layer>, layer_count> layers;
+            for(usize layer = 0; layer < layer_count; ++layer) {
+                layers[layer] = workers.submit([format, image = std::move(images[layer]), size = size]() mutable {
+                    return cook_layer(format, std::move(image), size);
+                });
+            }
+
+            // Tasks start in submission order, so once a worker starts this one every layer is done or running
+            // on another worker, and waiting for them cannot stall the pool.
+            workers.submit([layers = std::move(layers), format, source_stamp = source_stamp, size = size]() mutable {
+                std::vector<Cooked_Layer> cooked;
+                for(std::future<Cooked_Layer>& layer : layers) {
+                    cooked.push_back(layer.get());
+                }
+                if(!write_cooked_texture(block_texture_cache_file, source_stamp, format, size, cooked)) {
+                    std::cout << "[Warning] failed to write " << block_texture_cache_file << "\n";
+                }
+            });
+        }
+
+        // Format of newly cooked arrays.
+        Cooked_Format choose_format() const {
+#if defined(MINECRAFTPP_S3TC_BLOCK_TEXTURES)
+            if(supports_s3tc()) {
+                for(std::vector<u8> const& image : images) {
+                    for(usize i = 3; i < image.size(); i += 4) {
+                        if(image[i] != 255) {
+                            return Cooked_Format::bc3;
+                        }
+                    }
+                }
+                return Cooked_Format::bc1;
+            }
+#endif
+            return Cooked_Format::bc7;
+        }
+
+        // Whether a cooked array in format can be used as it is, or has to be cooked again.
+        static bool is_supported(Cooked_Format const format) {
+#if defined(MINECRAFTPP_S3TC_BLOCK_TEXTURES)
+            if(supports_s3tc()) {
+                return format == Cooked_Format::bc1 || format == Cooked_Format::bc3;
+            }
+#endif
+            return format == Cooked_Format::bc7;
+        }
+
+        static bool supports_s3tc() {
+            i32 extension_count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+            for(i32 i = 0; i < extension_count; ++i) {
+                char const* const extension = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, static_cast<u32>(i)));
+                if(extension && std::string_view(extension) == "GL_EXT_texture_compression_s3tc") {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static GLenum get_internal_format(Cooked_Format const format) {
+            switch(format) {
+                case Cooked_Format::bc1:
+                    return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                case Cooked_Format::bc3:
+                    return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case Cooked_Format::bc7:
+                    return GL_COMPRESSED_RGBA_BPTC_UNORM;
+                default:
+                    return GL_RGBA8;
+            }
+        }
+
+        void release_pixel_buffer() {
+            if(pixel_buffer != 0) {
+                glUnmapNamedBuffer(pixel_buffer);
+                glDeleteBuffers(1, &pixel_buffer);
+                pixel_buffer = 0;
+            }
+        }
+
+        // Runs on a worker. Decodes the image at path, which has to be source_size texels wide, and stores it
+        // in destination as RGBA scaled up to size, repeating every texel into a square of size / source_size texels.
+        static void decode(char const* const path, i32 const source_size, i32 const size, std::vector<u8>& destination) {
+            i32 width, height, components;
+            u8* const image = stbi_load(path, &width, &height, &components, 4);
+            if(!image || width != source_size || height != source_size) {
+                stbi_image_free(image);
+                throw std::runtime_error(std::string("block texture loading failed: ") + path);
+            }
+
+            i32 const factor = size / source_size;
+            destination.resize(static_cast<usize>(size) * size * 4);
+            for(i32 y = 0; y < size; ++y) {
+                for(i32 x = 0; x < size; ++x) {
+                    u8 const* const texel = &image[((y / factor) * source_size + x / factor) * 4];
+                    std::copy(texel, texel + 4, destination.begin() + (y * size + x) * 4);
+                }
+            }
+            stbi_image_free(image);
+        }
+    };
+}
+
+#endif // !MINECRAFTPP_BLOCK_TEXTURES_HPP
@@ -0,0 +1,92 @@
+#ifndef MINECRAFTPP_BUFFER_ALLOCATOR_HPP
+#define MINECRAFTPP_BUFFER_ALLOCATOR_HPP
+
+#include <types.hpp>
+
+#include <cassert>
+#include <iterator>
+#include <map>
+#include <optional>
+
+namespace minecraftpp {
+    // Range of a sub-allocation in units chosen by the user of the allocator.
+    struct Buffer_Range {
+        i64 offset = 0;
+        i64 size = 0;
+    };
+
+    // Sub-allocates ranges of a fixed size buffer. Free space is kept as a list of blocks ordered by offset,
+    // adjacent blocks are merged on free. Allocations take the lowest block that fits, which keeps live
+    // data packed towards the start of the buffer and lets compaction move ranges downwards.
+    class Buffer_Allocator {
+    public:
+        explicit Buffer_Allocator(i64 const capacity): capacity(capacity) {
+            free_blocks.emplace(0, capacity);
+        }
+
+        std::optional<i64> allocate(i64 const size) {
+            return allocate_below(size, capacity);
+        }
+
+        // Allocates a range that ends at or before limit.
+        std::optional<i64> allocate_below(i64 const size, i64 const limit) {
+            assert(size > 0);
+            for(auto iter = free_blocks.begin(); iter != free_blocks.end() && iter->first + size <= limit; ++iter) {
+                auto const [offset, block_size] = *iter;
+                if(block_size < size) {
+                    continue;
+                }
+
+                free_blocks.erase(iter);
+                if(block_size > size) {
+                    free_blocks.emplace(offset + size, block_size - size);
+                }
+                used += size;
+                return offset;
+            }
+            return std::nullopt;
+        }
+
+        void free(Buffer_Range const range) {
+            assert(range.size > 0);
+            used -= range.size;
+            auto next = free_blocks.lower_bound(range.offset);
+            i64 offset = range.offset;
+            i64 size = range.size;
+            if(next != free_blocks.begin()) {
+                auto const previous = std::prev(next);
+                if(previous->first + previous->second == offset) {
+                    offset = previous->first;
+                    size += previous->second;
+                    free_blocks.erase(previous);
+                }
+            }
+            if(next != free_blocks.end() && next->first == range.offset + range.size) {
+                size += next->second;
+                free_blocks.erase(next);
+            }
+            free_blocks.emplace(offset, size);
+        }
+
+        i64 get_used() const {
+            return used;
+        }
+
+        i64 get_capacity() const {
+            return capacity;
+        }
+
+        // Number of separate free blocks, 1 when the free space is contiguous.
+        i64 get_free_block_count() const {
+            return free_blocks.size();
+        }
+
+    private:
+        // Free blocks as offset -> size.
+        std::map<i64, i64> free_blocks;
+        i64 capacity;
+        i64 used = 0;
+    };
+}
+
+#endif // !MINECRAFTPP_BUFFER_ALLOCATOR_HPP
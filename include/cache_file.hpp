@@ -0,0 +1,51 @@
+#ifndef MINECRAFTPP_CACHE_FILE_HPP
+#define MINECRAFTPP_CACHE_FILE_HPP
+
+#include <types.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+// Pieces shared by the on-disk caches: a hash to key or stamp their files with, and a writer that never
+// leaves a truncated file behind.
+namespace minecraftpp {
+    // 64-bit FNV-1a over everything mixed in, in order.
+    class Fnv1a {
+    public:
+        void mix(void const* const bytes, usize const count) {
+            for(usize i = 0; i < count; ++i) {
+                hash = (hash ^ static_cast<u8 const*>(bytes)[i]) * 0x100000001B3;
+            }
+        }
+
+        u64 get_hash() const {
+            return hash;
+        }
+
+    private:
+        u64 hash = 0xCBF29CE484222325;
+    };
+
+    // Creates the parent directories of path, lets write fill a file next to it and renames that file over path
+    // once complete, so that a crash never leaves a truncated file at path. Returns false on failure.
+    template<typename Write>
+    bool write_file_atomically(std::filesystem::path const& path, Write const& write) {
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream output{temporary, std::ios::binary | std::ios::trunc};
+            write(output);
+            if(!output) {
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporary, path, error);
+        return !error;
+    }
+}
+
+#endif // !MINECRAFTPP_CACHE_FILE_HPP
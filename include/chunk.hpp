@@ -0,0 +1,402 @@
+#ifndef MINECRAFTPP_CHUNK_HPP
+#define MINECRAFTPP_CHUNK_HPP
+
+#include <buffer_allocator.hpp>
+#include <chunk_layout.hpp>
+#include <types.hpp>
+
+#include "glm/glm.hpp"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace minecraftpp {
+    // Faces are ordered by axis, negative direction first, so that face / 2 is the axis
+    // and face & 1 tells whether the face points along the positive direction.
+    enum class Face {
+        neg_x, pos_x, neg_y, pos_y, neg_z, pos_z,
+    };
+
+    // Unit step in chunk or block coordinates towards each face.
+    inline constexpr std::array<std::array<i32, 3>, 6> face_directions{{
+        {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1},
+    }};
+
+    enum class Block_Type : u16 {
+        air, dirt, grass,
+    };
+
+    inline bool is_opaque(Block_Type const block) {
+        return block != Block_Type::air;
+    }
+
+    // Layers of the block texture array. block_textures.hpp lists the file each layer is loaded from.
+    enum class Block_Texture : u16 {
+        dirt, grass_top, grass_side, grass_bottom,
+    };
+
+    // Texture shown on the given face of a block. Only meaningful for opaque blocks.
+    inline Block_Texture face_texture(Block_Type const block, Face const face) {
+        switch(block) {
+            case Block_Type::grass:
+                if(face == Face::pos_y) {
+                    return Block_Texture::grass_top;
+                } else if(face == Face::neg_y) {
+                    return Block_Texture::grass_bottom;
+                } else {
+                    return Block_Texture::grass_side;
+                }
+            default:
+                return Block_Texture::dirt;
+        }
+    }
+
+    // Chunk mesh quad packed into 32 bits. Bits 0-11 hold x, y and z of the block at the quad's origin relative
+    // to the chunk origin (4 bits each), bits 12-15 and 16-19 the width and height minus one along the face's
+    // u and v axes, bits 20-22 the face and bits 23-31 the layer of the block texture array.
+    // There are no vertices: v_block.glsl fetches the quad of each vertex from a storage buffer and derives
+    // the corner position and texture coordinates from it.
+    struct Quad {
+        u32 data;
+    };
+
+    inline Quad pack_quad(i32 const x, i32 const y, i32 const z, i32 const w, i32 const h, Face const face, Block_Texture const texture) {
+        return {static_cast<u32>(x) | static_cast<u32>(y) << 4 | static_cast<u32>(z) << 8 | static_cast<u32>(w - 1) << 12 |
+                static_cast<u32>(h - 1) << 16 | static_cast<u32>(face) << 20 | static_cast<u32>(texture) << 23};
+    }
+
+    // Which pairs of chunk faces are connected through transparent blocks, as a symmetric 6x6 bit matrix
+    // with bit a * 6 + b set when faces a and b are. A face is connected to itself when any transparent
+    // block touches it. Used to skip chunks that cannot be seen from the camera chunk, see visibility.hpp.
+    struct Face_Connections {
+        u64 bits = 0;
+
+        static Face_Connections all() {
+            return {(u64(1) << 36) - 1};
+        }
+
+        // Connects every pair of the faces in the bit mask faces (1 << Face).
+        void connect(u8 const faces) {
+            for(i32 a = 0; a < 6; ++a) {
+                if(faces & (1 << a)) {
+                    bits |= u64(faces) << (a * 6);
+                }
+            }
+        }
+
+        bool connects(Face const a, Face const b) const {
+            return (bits >> (static_cast<i32>(a) * 6 + static_cast<i32>(b))) & 1;
+        }
+    };
+
+    // Geometry of a single chunk as a list of quads. Every quad is drawn as 4 vertices forming the
+    // triangles (0, 1, 2) and (2, 3, 0).
+    struct Chunk_Mesh {
+        std::vector<Quad> quads;
+    };
+
+    // Block storage of a chunk. Blocks are stored as indices into a per-chunk palette, bit-packed into
+    // 64-bit words. The index width is a power of two (1, 2, 4, 8 or 16 bits), so an index never straddles
+    // two words, and it doubles whenever the palette outgrows it. Palette entries are never removed.
+    //
+    // A uniform chunk uses 0 bits per block. It only keeps its single palette entry and allocates
+    // no index data until the first write of a different block.
+    class Palette_Storage {
+    public:
+        Block_Type get(i32 const index) const {
+            if(bits == 0) {
+                return palette[0];
+            }
+
+            return palette[read_index(data, bits, index)];
+        }
+
+        void set(i32 const index, Block_Type const block) {
+            u32 const palette_index = find_or_insert(block);
+            if(bits != 0) {
+                write_index(data, bits, index, palette_index);
+            }
+        }
+
+        // Opacity of the 16 consecutive blocks starting at row * 16 as a bit mask with the first block in bit 0.
+        u16 opaque_row(i32 const row) const {
+            if(bits == 0) {
+                return is_opaque(palette[0]) ? 0xFFFF : 0;
+            }
+
+            if(bits == 1) {
+                // A whole row of 1-bit indices sits in one 16-bit lane of a word, so it can be mapped at once.
+                u16 const indices = data[row / 4] >> (row % 4 * 16);
+                u16 const first_opaque = is_opaque(palette[0]) ? ~indices : 0;
+                u16 const second_opaque = palette.size() > 1 && is_opaque(palette[1]) ? indices : 0;
+                return first_opaque | second_opaque;
+            }
+
+            u16 result = 0;
+            for(i32 i = 0; i < 16; ++i) {
+                result |= is_opaque(palette[read_index(data, bits, row * 16 + i)]) << i;
+            }
+            return result;
+        }
+
+        // Makes every block the same, releasing the index data.
+        void fill(Block_Type const block) {
+            palette = {block};
+            data = {};
+            bits = 0;
+        }
+
+        bool is_uniform() const {
+            return bits == 0;
+        }
+
+        // Heap and inline memory taken by the storage in bytes.
+        usize memory_usage() const {
+            return sizeof(*this) + palette.capacity() * sizeof(Block_Type) + data.capacity() * sizeof(u64);
+        }
+
+    private:
+        std::vector<Block_Type> palette{Block_Type::air};
+        std::vector<u64> data;
+        u32 bits = 0;
+
+        static u32 read_index(std::vector<u64> const& data, u32 const bits, i32 const index) {
+            u32 const bit = index * bits;
+            u64 const mask = (u64(1) << bits) - 1;
+            return (data[bit / 64] >> (bit % 64)) & mask;
+        }
+
+        static void write_index(std::vector<u64>& data, u32 const bits, i32 const index, u32 const value) {
+            u32 const bit = index * bits;
+            u64 const mask = ((u64(1) << bits) - 1) << (bit % 64);
+            u64& word = data[bit / 64];
+            word = (word & ~mask) | (u64(value) << (bit % 64));
+        }
+
+        u32 find_or_insert(Block_Type const block) {
+            for(u32 i = 0; i < palette.size(); ++i) {
+                if(palette[i] == block) {
+                    return i;
+                }
+            }
+
+            palette.push_back(block);
+            if(palette.size() > (usize(1) << bits)) {
+                grow();
+            }
+            return palette.size() - 1;
+        }
+
+        void grow() {
+            u32 const new_bits = bits != 0 ? bits * 2 : 1;
+            std::vector<u64> new_data(4096 * new_bits / 64, 0);
+            // Expanding a uniform chunk leaves every index at 0, which already is its only palette entry.
+            if(bits != 0) {
+                for(i32 i = 0; i < 4096; ++i) {
+                    write_index(new_data, new_bits, i, read_index(data, bits, i));
+                }
+            }
+            data = std::move(new_data);
+            bits = new_bits;
+        }
+    };
+
+    // A 16^3 block of the world. Layout decides how block coordinates map to indices of the block storage,
+    // see chunk_layout.hpp. Use the Chunk alias unless comparing layouts.
+    template<typename Layout>
+    struct Basic_Chunk {
+        // Position of the chunk in chunk units. The chunk spans [coordinates * 16, coordinates * 16 + 16) in blocks.
+        glm::ivec3 coordinates{};
+        // Cached output of build_mesh(). Only valid while dirty is false.
+        Chunk_Mesh mesh;
+        // Range of the mesh in the Mesh_Buffer in quads. Empty while the mesh is not uploaded.
+        Buffer_Range mesh_range;
+        // Bit mask of faces (1 << Face) whose whole border layer is opaque, as of the last meshing.
+        // Those faces are used as occluders, see occlusion.hpp.
+        u8 opaque_borders = 0;
+        // Connectivity of the faces through the chunk as of the last meshing. Fully connected until then.
+        Face_Connections face_connections = Face_Connections::all();
+        // Position of the chunk in the front to back draw order, see draw_order.hpp.
+        u32 draw_rank = 0;
+        // Set by every block write. The render loop remeshes and reuploads dirty chunks only.
+        bool dirty = true;
+        // Bit mask of faces (1 << Face) whose border layer changed since the neighbours were last
+        // told about it. A freshly created chunk has all bits set so that its neighbours get remeshed.
+        u8 dirty_borders = 0x3F;
+
+        Basic_Chunk() = default;
+        // blocks is indexed as z * 256 + y * 16 + x regardless of Layout.
+        explicit Basic_Chunk(std::array<Block_Type, 4096> const& blocks) {
+            for(i32 i = 0; i < 4096; ++i) {
+                auto const [x, y, z] = Linear_Layout::position(i);
+                this->blocks.set(Layout::index(x, y, z), blocks[i]);
+            }
+        }
+
+        Block_Type block_at(i32 const x, i32 const y, i32 const z) const {
+            if(x < 0 || x > 15 || y < 0 || y > 15 || z < 0 || z > 15) {
+                return Block_Type::air;
+            } else {
+                return blocks.get(Layout::index(x, y, z));
+            }
+        }
+
+        void set_block(i32 const x, i32 const y, i32 const z, Block_Type const block) {
+            blocks.set(Layout::index(x, y, z), block);
+            dirty = true;
+            dirty_borders |= (x == 0) << static_cast<i32>(Face::neg_x) | (x == 15) << static_cast<i32>(Face::pos_x) |
+                             (y == 0) << static_cast<i32>(Face::neg_y) | (y == 15) << static_cast<i32>(Face::pos_y) |
+                             (z == 0) << static_cast<i32>(Face::neg_z) | (z == 15) << static_cast<i32>(Face::pos_z);
+        }
+
+        // Opacity of the blocks along x at the given y and z, with x = 0 in bit 0.
+        u16 opaque_row(i32 const y, i32 const z) const {
+            if constexpr(Layout::contiguous_rows) {
+                return blocks.opaque_row(Layout::index(0, y, z) / 16);
+            } else {
+                if(blocks.is_uniform()) {
+                    return blocks.opaque_row(0);
+                }
+
+                u16 result = 0;
+                for(i32 x = 0; x < 16; ++x) {
+                    result |= is_opaque(blocks.get(Layout::index(x, y, z))) << x;
+                }
+                return result;
+            }
+        }
+
+        // Bit mask of faces (1 << Face) whose border layer of blocks is entirely opaque.
+        u8 opaque_border_faces() const {
+            if(blocks.is_uniform()) {
+                return is_opaque(blocks.get(0)) ? 0x3F : 0;
+            }
+
+            u16 neg_x = 1, pos_x = 1 << 15;
+            bool neg_y = true, pos_y = true, neg_z = true, pos_z = true;
+            for(i32 z = 0; z < 16; ++z) {
+                for(i32 y = 0; y < 16; ++y) {
+                    u16 const row = opaque_row(y, z);
+                    neg_x &= row;
+                    pos_x &= row;
+                    neg_y &= y != 0 || row == 0xFFFF;
+                    pos_y &= y != 15 || row == 0xFFFF;
+                    neg_z &= z != 0 || row == 0xFFFF;
+                    pos_z &= z != 15 || row == 0xFFFF;
+                }
+            }
+            return (neg_x != 0) << static_cast<i32>(Face::neg_x) | (pos_x != 0) << static_cast<i32>(Face::pos_x) |
+                   neg_y << static_cast<i32>(Face::neg_y) | pos_y << static_cast<i32>(Face::pos_y) |
+                   neg_z << static_cast<i32>(Face::neg_z) | pos_z << static_cast<i32>(Face::pos_z);
+        }
+
+        // Flood fills the transparent blocks and connects the faces touched by each region.
+        Face_Connections compute_face_connections() const {
+            Face_Connections connections;
+            if(blocks.is_uniform()) {
+                return is_opaque(blocks.get(0)) ? connections : Face_Connections::all();
+            }
+
+            // Rows along x indexed by z * 16 + y with a bit set for every transparent block not reached yet.
+            std::array<u16, 256> open;
+            for(i32 z = 0; z < 16; ++z) {
+                for(i32 y = 0; y < 16; ++y) {
+                    open[z * 16 + y] = ~opaque_row(y, z);
+                }
+            }
+
+            std::array<u16, 4096> stack;
+            for(i32 start = 0; start < 4096; ++start) {
+                if(!(open[start / 16] & (1 << (start % 16)))) {
+                    continue;
+                }
+
+                u8 faces = 0;
+                i32 size = 0;
+                stack[size++] = start;
+                open[start / 16] &= ~(1 << (start % 16));
+                while(size > 0) {
+                    i32 const block = stack[--size];
+                    i32 const x = block % 16;
+                    i32 const y = block / 16 % 16;
+                    i32 const z = block / 256;
+                    faces |= (x == 0) << static_cast<i32>(Face::neg_x) | (x == 15) << static_cast<i32>(Face::pos_x) |
+                             (y == 0) << static_cast<i32>(Face::neg_y) | (y == 15) << static_cast<i32>(Face::pos_y) |
+                             (z == 0) << static_cast<i32>(Face::neg_z) | (z == 15) << static_cast<i32>(Face::pos_z);
+                    for(auto const [dx, dy, dz] : face_directions) {
+                        i32 const nx = x + dx, ny = y + dy, nz = z + dz;
+                        if(nx < 0 || nx > 15 || ny < 0 || ny > 15 || nz < 0 || nz > 15) {
+                            continue;
+                        }
+
+                        u16& row = open[nz * 16 + ny];
+                        if(row & (1 << nx)) {
+                            row &= ~(1 << nx);
+                            stack[size++] = nz * 256 + ny * 16 + nx;
+                        }
+                    }
+                }
+                connections.connect(faces);
+            }
+            return connections;
+        }
+
+        void fill(Block_Type const block) {
+            blocks.fill(block);
+            dirty = true;
+            dirty_borders = 0x3F;
+        }
+
+        // Whether all blocks of the chunk are the same, in which case block_at(0, 0, 0) tells which.
+        bool is_uniform() const {
+            return blocks.is_uniform();
+        }
+
+        // Memory taken by the block storage in bytes.
+        usize memory_usage() const {
+            return blocks.memory_usage();
+        }
+
+    private:
+        Palette_Storage blocks;
+    };
+
+    using Chunk = Basic_Chunk<Chunk_Layout>;
+
+    // A chunk together with its six neighbours indexed by Face. Lookups that leave the chunk
+    // are forwarded to the neighbour on that side. Missing neighbours read as air.
+    template<typename Layout>
+    struct Basic_Chunk_Neighbourhood {
+        Basic_Chunk<Layout> const& chunk;
+        std::array<Basic_Chunk<Layout> const*, 6> neighbours;
+
+        Block_Type block_at(i32 const x, i32 const y, i32 const z) const {
+            if(x < 0) {
+                return neighbour_block_at(Face::neg_x, x + 16, y, z);
+            } else if(x > 15) {
+                return neighbour_block_at(Face::pos_x, x - 16, y, z);
+            } else if(y < 0) {
+                return neighbour_block_at(Face::neg_y, x, y + 16, z);
+            } else if(y > 15) {
+                return neighbour_block_at(Face::pos_y, x, y - 16, z);
+            } else if(z < 0) {
+                return neighbour_block_at(Face::neg_z, x, y, z + 16);
+            } else if(z > 15) {
+                return neighbour_block_at(Face::pos_z, x, y, z - 16);
+            } else {
+                return chunk.block_at(x, y, z);
+            }
+        }
+
+    private:
+        Block_Type neighbour_block_at(Face const face, i32 const x, i32 const y, i32 const z) const {
+            Basic_Chunk<Layout> const* const neighbour = neighbours[static_cast<i32>(face)];
+            return neighbour ? neighbour->block_at(x, y, z) : Block_Type::air;
+        }
+    };
+
+    using Chunk_Neighbourhood = Basic_Chunk_Neighbourhood<Chunk_Layout>;
+}
+
+#endif // !MINECRAFTPP_CHUNK_HPP
@@ -0,0 +1,80 @@
+#ifndef MINECRAFTPP_CHUNK_LAYOUT_HPP
+#define MINECRAFTPP_CHUNK_LAYOUT_HPP
+
+#include <types.hpp>
+
+#include <array>
+#include <type_traits>
+
+#if defined(__BMI2__)
+    #include <immintrin.h>
+#endif
+
+// Layout policies map local block coordinates in [0, 15] to an index in [0, 4095] of a chunk's block storage.
+// Define MINECRAFTPP_MORTON_CHUNK_LAYOUT to store chunks in Morton order instead of row-major order.
+
+namespace minecraftpp {
+    // Row-major order. Rows along x are contiguous, rows along y are 16 entries apart and slices along z 256.
+    struct Linear_Layout {
+        // Whether the 16 blocks along x at fixed y and z occupy consecutive indices starting at a multiple of 16.
+        static constexpr bool contiguous_rows = true;
+
+        static constexpr i32 index(i32 const x, i32 const y, i32 const z) {
+            return z * 256 + y * 16 + x;
+        }
+
+        static constexpr std::array<i32, 3> position(i32 const index) {
+            return {index & 15, (index >> 4) & 15, index >> 8};
+        }
+    };
+
+    // Spreads the low 4 bits of value to bits 0, 3, 6 and 9.
+    inline constexpr u32 morton_spread(u32 const value) {
+#if defined(__BMI2__)
+        if(!std::is_constant_evaluated()) {
+            return _pdep_u32(value, 0x249);
+        }
+#endif
+        u32 result = value & 0xF;
+        result = (result | result << 4) & 0x0C3;
+        result = (result | result << 2) & 0x249;
+        return result;
+    }
+
+    // Gathers bits 0, 3, 6 and 9 of value into the low 4 bits.
+    inline constexpr u32 morton_compact(u32 const value) {
+#if defined(__BMI2__)
+        if(!std::is_constant_evaluated()) {
+            return _pext_u32(value, 0x249);
+        }
+#endif
+        u32 result = value & 0x249;
+        result = (result | result >> 2) & 0x0C3;
+        result = (result | result >> 4) & 0x00F;
+        return result;
+    }
+
+    // Z-order curve with the bits of x, y and z interleaved, x lowest. Each 2x2x2 block group, and
+    // recursively each 4x4x4 and 8x8x8 group, occupies a contiguous range, so neighbours along any
+    // axis tend to share cache lines.
+    struct Morton_Layout {
+        static constexpr bool contiguous_rows = false;
+
+        static constexpr i32 index(i32 const x, i32 const y, i32 const z) {
+            return morton_spread(x) | morton_spread(y) << 1 | morton_spread(z) << 2;
+        }
+
+        static constexpr std::array<i32, 3> position(i32 const index) {
+            return {static_cast<i32>(morton_compact(index)), static_cast<i32>(morton_compact(index >> 1)),
+                    static_cast<i32>(morton_compact(index >> 2))};
+        }
+    };
+
+#if defined(MINECRAFTPP_MORTON_CHUNK_LAYOUT)
+    using Chunk_Layout = Morton_Layout;
+#else
+    using Chunk_Layout = Linear_Layout;
+#endif
+}
+
+#endif // !MINECRAFTPP_CHUNK_LAYOUT_HPP
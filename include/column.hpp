@@ -0,0 +1,78 @@
+#ifndef MINECRAFTPP_COLUMN_HPP
+#define MINECRAFTPP_COLUMN_HPP
+
+#include <chunk.hpp>
+#include <types.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace minecraftpp {
+    // A vertical stack of chunk sections sharing the same x and z chunk coordinates, covering world y
+    // in [0, height). Sections are created on first use, so the air above the terrain takes no storage.
+    //
+    // The column also keeps a heightmap of its highest opaque blocks. Surface queries, spawn placement,
+    // sky light and horizon culling can start there instead of walking down through empty sections.
+    // It is only kept up to date for writes that go through World.
+    struct Column {
+        static constexpr i32 section_count = 16;
+        static constexpr i32 height = section_count * 16;
+
+        // Sections by chunk y. Null for sections that were never loaded.
+        std::array<Chunk*, section_count> sections{};
+
+        Column() {
+            heightmap.fill(-1);
+        }
+
+        // World y of the highest opaque block at local x and z, or -1 when the column is transparent there.
+        i32 height_at(i32 const x, i32 const z) const {
+            return heightmap[z * 16 + x];
+        }
+
+        // Updates the heightmap after the block at local x and z and world y became block.
+        void on_block_changed(i32 const x, i32 const y, i32 const z, Block_Type const block) {
+            i16& top = heightmap[z * 16 + x];
+            if(is_opaque(block)) {
+                top = std::max<i16>(top, y);
+            } else if(y == top) {
+                top = find_height(x, y - 1, z);
+            }
+        }
+
+        // Updates the heightmap after every block of the section at chunk y became block.
+        void on_section_filled(i32 const section_y, Block_Type const block) {
+            i32 const bottom = section_y * 16;
+            for(i32 z = 0; z < 16; ++z) {
+                for(i32 x = 0; x < 16; ++x) {
+                    i16& top = heightmap[z * 16 + x];
+                    if(is_opaque(block)) {
+                        top = std::max<i16>(top, bottom + 15);
+                    } else if(top >= bottom && top < bottom + 16) {
+                        top = find_height(x, bottom - 1, z);
+                    }
+                }
+            }
+        }
+
+    private:
+        std::array<i16, 256> heightmap;
+
+        // Walks down from world y to the first opaque block, skipping missing and transparent uniform sections.
+        i16 find_height(i32 const x, i32 y, i32 const z) const {
+            while(y >= 0) {
+                Chunk const* const section = sections[y / 16];
+                if(!section || (section->is_uniform() && !is_opaque(section->block_at(0, 0, 0)))) {
+                    y = y / 16 * 16 - 1;
+                } else if(is_opaque(section->block_at(x, y % 16, z))) {
+                    return y;
+                } else {
+                    --y;
+                }
+            }
+            return -1;
+        }
+    };
+}
+
+#endif // !MINECRAFTPP_COLUMN_HPP
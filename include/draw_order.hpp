@@ -0,0 +1,84 @@
+#ifndef MINECRAFTPP_DRAW_ORDER_HPP
+#define MINECRAFTPP_DRAW_ORDER_HPP
+
+#include <chunk.hpp>
+#include <types.hpp>
+
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+namespace minecraftpp {
+    // All loaded chunks sorted front to back by their distance from the camera chunk, so that opaque
+    // geometry drawn in rank order lets early depth testing reject the fragments it hides. The order
+    // only depends on the camera chunk, so it is only updated when the camera crosses into another chunk
+    // or chunks get loaded. Each chunk's position in the order is kept in its draw_rank.
+    class Draw_Order {
+    public:
+        // Chunks are never unloaded, so chunks past the end of the order are the ones loaded since the last update.
+        void update(std::deque<Chunk>& chunks, glm::ivec3 const camera_chunk) {
+            usize const known = order.size();
+            if(known == chunks.size() && known != 0 && camera_chunk == sorted_for) {
+                return;
+            }
+
+            for(usize i = known; i < chunks.size(); ++i) {
+                order.push_back(&chunks[i]);
+            }
+
+            auto const closer = [&](Chunk const* const a, Chunk const* const b) {
+                return distance_squared(a->coordinates, camera_chunk) < distance_squared(b->coordinates, camera_chunk);
+            };
+            // After a step into a neighbouring chunk only chunks at nearly the same distance swap places, so the
+            // previous order is almost sorted and insertion sort finishes in close to linear time.
+            glm::ivec3 const step{camera_chunk.x - sorted_for.x, camera_chunk.y - sorted_for.y, camera_chunk.z - sorted_for.z};
+            bool const nearly_sorted = known != 0 && chunks.size() - known <= max_insertions && std::abs(step.x) <= 1 &&
+                                       std::abs(step.y) <= 1 && std::abs(step.z) <= 1;
+            if(nearly_sorted) {
+                for(usize i = 1; i < order.size(); ++i) {
+                    Chunk* const chunk = order[i];
+                    usize j = i;
+                    for(; j > 0 && closer(chunk, order[j - 1]); --j) {
+                        order[j] = order[j - 1];
+                    }
+                    order[j] = chunk;
+                }
+            } else {
+                std::stable_sort(order.begin(), order.end(), closer);
+            }
+
+            for(usize i = 0; i < order.size(); ++i) {
+                order[i]->draw_rank = static_cast<u32>(i);
+            }
+            sorted_for = camera_chunk;
+        }
+
+        // Sorts a subset of the chunks into draw order.
+        static void sort(std::vector<Chunk const*>& chunks) {
+            std::sort(chunks.begin(), chunks.end(), [](Chunk const* const a, Chunk const* const b) {
+                return a->draw_rank < b->draw_rank;
+            });
+        }
+
+        std::vector<Chunk*> const& get_chunks() const {
+            return order;
+        }
+
+    private:
+        // Newly loaded chunks can land anywhere in the order, so many of them at once go through a full sort.
+        static constexpr usize max_insertions = 64;
+
+        std::vector<Chunk*> order;
+        glm::ivec3 sorted_for{};
+
+        static i32 distance_squared(glm::ivec3 const a, glm::ivec3 const b) {
+            glm::ivec3 const d{a.x - b.x, a.y - b.y, a.z - b.z};
+            return d.x * d.x + d.y * d.y + d.z * d.z;
+        }
+    };
+}
+
+#endif // !MINECRAFTPP_DRAW_ORDER_HPP
@@ -0,0 +1,152 @@
+#ifndef MINECRAFTPP_FACE_MASKS_HPP
+#define MINECRAFTPP_FACE_MASKS_HPP
+
+#include <chunk.hpp>
+#include <types.hpp>
+
+#include <array>
+
+// Define MINECRAFTPP_FACE_MASKS_SCALAR to use the scalar path on any target, so that tests can cover it.
+#if defined(MINECRAFTPP_FACE_MASKS_SCALAR)
+#elif defined(__AVX2__)
+    #include <immintrin.h>
+    #define MINECRAFTPP_FACE_MASKS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define MINECRAFTPP_FACE_MASKS_SSE2
+#endif
+
+namespace minecraftpp {
+    // Exposed block faces of a chunk. rows[face][z * 16 + y] has bit x set when the block at (x, y, z)
+    // is opaque and its neighbour in the direction of face is not.
+    struct Face_Masks {
+        std::array<std::array<u16, 256>, 6> rows;
+
+        bool is_exposed(Face const face, i32 const x, i32 const y, i32 const z) const {
+            return (rows[static_cast<i32>(face)][z * 16 + y] >> x) & 1;
+        }
+    };
+
+    // Occupancy of a chunk as one opaque bit per block, padded with the border layers of its neighbours.
+    // Rows along x are stored for y and z in [-1, 16] so that the y and z neighbours of a row are plain
+    // loads at a fixed offset. The blocks at x = -1 and x = 16 are kept as separate rows that already
+    // sit in the bit they shift into.
+    struct Padded_Occupancy {
+        static constexpr i32 stride = 18;
+
+        alignas(32) std::array<u16, stride * stride> rows{};
+        alignas(32) std::array<u16, 256> neg_x_border{};
+        alignas(32) std::array<u16, 256> pos_x_border{};
+
+        template<typename Layout>
+        explicit Padded_Occupancy(Basic_Chunk_Neighbourhood<Layout> const& neighbourhood) {
+            for(i32 z = 0; z < 16; ++z) {
+                for(i32 y = 0; y < 16; ++y) {
+                    rows[row_index(y, z)] = neighbourhood.chunk.opaque_row(y, z);
+                }
+            }
+
+            auto const& neighbours = neighbourhood.neighbours;
+            // Missing neighbours stay zero, which is air.
+            if(Basic_Chunk<Layout> const* const chunk = neighbours[static_cast<i32>(Face::neg_x)]) {
+                for(i32 i = 0; i < 256; ++i) {
+                    neg_x_border[i] = chunk->opaque_row(i % 16, i / 16) >> 15;
+                }
+            }
+            if(Basic_Chunk<Layout> const* const chunk = neighbours[static_cast<i32>(Face::pos_x)]) {
+                for(i32 i = 0; i < 256; ++i) {
+                    pos_x_border[i] = (chunk->opaque_row(i % 16, i / 16) & 1) << 15;
+                }
+            }
+            for(i32 i = 0; i < 16; ++i) {
+                if(Basic_Chunk<Layout> const* const chunk = neighbours[static_cast<i32>(Face::neg_y)]) {
+                    rows[row_index(-1, i)] = chunk->opaque_row(15, i);
+                }
+                if(Basic_Chunk<Layout> const* const chunk = neighbours[static_cast<i32>(Face::pos_y)]) {
+                    rows[row_index(16, i)] = chunk->opaque_row(0, i);
+                }
+                if(Basic_Chunk<Layout> const* const chunk = neighbours[static_cast<i32>(Face::neg_z)]) {
+                    rows[row_index(i, -1)] = chunk->opaque_row(i, 15);
+                }
+                if(Basic_Chunk<Layout> const* const chunk = neighbours[static_cast<i32>(Face::pos_z)]) {
+                    rows[row_index(i, 16)] = chunk->opaque_row(i, 0);
+                }
+            }
+        }
+
+        static constexpr i32 row_index(i32 const y, i32 const z) {
+            return (z + 1) * stride + y + 1;
+        }
+    };
+
+    // Computes exposed faces for all six directions with shifts and and-nots over whole rows,
+    // 16 rows at a time with AVX2, 8 with SSE2 or one at a time otherwise. Gives the same result
+    // as testing every block against its six neighbours through the neighbourhood.
+    template<typename Layout>
+    Face_Masks compute_face_masks(Basic_Chunk_Neighbourhood<Layout> const& neighbourhood) {
+        Padded_Occupancy const occupancy{neighbourhood};
+        u16 const* const rows = occupancy.rows.data();
+        Face_Masks masks;
+        auto const mask_rows = [&masks](Face const face, i32 const z) {
+            return masks.rows[static_cast<i32>(face)].data() + z * 16;
+        };
+
+        for(i32 z = 0; z < 16; ++z) {
+            i32 const row = Padded_Occupancy::row_index(0, z);
+            i32 const border = z * 16;
+#if defined(MINECRAFTPP_FACE_MASKS_AVX2)
+            auto const load = [](u16 const* const address) {
+                return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(address));
+            };
+            auto const store = [](u16* const address, __m256i const value) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(address), value);
+            };
+
+            __m256i const blocks = load(rows + row);
+            __m256i const neg_x = _mm256_or_si256(_mm256_slli_epi16(blocks, 1), load(occupancy.neg_x_border.data() + border));
+            __m256i const pos_x = _mm256_or_si256(_mm256_srli_epi16(blocks, 1), load(occupancy.pos_x_border.data() + border));
+            store(mask_rows(Face::neg_x, z), _mm256_andnot_si256(neg_x, blocks));
+            store(mask_rows(Face::pos_x, z), _mm256_andnot_si256(pos_x, blocks));
+            store(mask_rows(Face::neg_y, z), _mm256_andnot_si256(load(rows + row - 1), blocks));
+            store(mask_rows(Face::pos_y, z), _mm256_andnot_si256(load(rows + row + 1), blocks));
+            store(mask_rows(Face::neg_z, z), _mm256_andnot_si256(load(rows + row - Padded_Occupancy::stride), blocks));
+            store(mask_rows(Face::pos_z, z), _mm256_andnot_si256(load(rows + row + Padded_Occupancy::stride), blocks));
+#elif defined(MINECRAFTPP_FACE_MASKS_SSE2)
+            auto const load = [](u16 const* const address) {
+                return _mm_loadu_si128(reinterpret_cast<__m128i const*>(address));
+            };
+            auto const store = [](u16* const address, __m128i const value) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(address), value);
+            };
+
+            for(i32 y = 0; y < 16; y += 8) {
+                __m128i const blocks = load(rows + row + y);
+                __m128i const neg_x = _mm_or_si128(_mm_slli_epi16(blocks, 1), load(occupancy.neg_x_border.data() + border + y));
+                __m128i const pos_x = _mm_or_si128(_mm_srli_epi16(blocks, 1), load(occupancy.pos_x_border.data() + border + y));
+                store(mask_rows(Face::neg_x, z) + y, _mm_andnot_si128(neg_x, blocks));
+                store(mask_rows(Face::pos_x, z) + y, _mm_andnot_si128(pos_x, blocks));
+                store(mask_rows(Face::neg_y, z) + y, _mm_andnot_si128(load(rows + row + y - 1), blocks));
+                store(mask_rows(Face::pos_y, z) + y, _mm_andnot_si128(load(rows + row + y + 1), blocks));
+                store(mask_rows(Face::neg_z, z) + y, _mm_andnot_si128(load(rows + row + y - Padded_Occupancy::stride), blocks));
+                store(mask_rows(Face::pos_z, z) + y, _mm_andnot_si128(load(rows + row + y + Padded_Occupancy::stride), blocks));
+            }
+#else
+            for(i32 y = 0; y < 16; ++y) {
+                u16 const blocks = rows[row + y];
+                u16 const neg_x = static_cast<u16>(blocks << 1) | occupancy.neg_x_border[border + y];
+                u16 const pos_x = static_cast<u16>(blocks >> 1) | occupancy.pos_x_border[border + y];
+                mask_rows(Face::neg_x, z)[y] = blocks & ~neg_x;
+                mask_rows(Face::pos_x, z)[y] = blocks & ~pos_x;
+                mask_rows(Face::neg_y, z)[y] = blocks & ~rows[row + y - 1];
+                mask_rows(Face::pos_y, z)[y] = blocks & ~rows[row + y + 1];
+                mask_rows(Face::neg_z, z)[y] = blocks & ~rows[row + y - Padded_Occupancy::stride];
+                mask_rows(Face::pos_z, z)[y] = blocks & ~rows[row + y + Padded_Occupancy::stride];
+            }
+#endif
+        }
+
+        return masks;
+    }
+}
+
+#endif // !MINECRAFTPP_FACE_MASKS_HPP
@@ -0,0 +1,33 @@
+#ifndef MINECRAFTPP_FRAME_UNIFORMS_HPP
+#define MINECRAFTPP_FRAME_UNIFORMS_HPP
+
+#include <types.hpp>
+
+#include "glm/glm.hpp"
+
+namespace minecraftpp {
+    // Binding point of the Frame uniform block. Every shader declares the block with this binding.
+    inline constexpr u32 frame_uniforms_binding = 0;
+
+    // Render state shared by all shaders, written once per frame into the streaming buffer. Mirrors the
+    // std140 Frame uniform block in the shaders, so members have to be kept in the same order there.
+    struct Frame_Uniforms {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 view_projection;
+        // w is unused.
+        glm::vec4 camera_position;
+        // a is unused.
+        glm::vec4 fog_color;
+        // Distances from the camera where fog starts and where it fully hides the scene.
+        f32 fog_start;
+        f32 fog_end;
+        // Seconds since the start of the application.
+        f32 time;
+        f32 padding;
+    };
+
+    static_assert(sizeof(Frame_Uniforms) == 240, "Frame_Uniforms has to match the std140 layout of the Frame block");
+}
+
+#endif // !MINECRAFTPP_FRAME_UNIFORMS_HPP
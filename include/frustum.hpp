@@ -0,0 +1,143 @@
+#ifndef MINECRAFTPP_FRUSTUM_HPP
+#define MINECRAFTPP_FRUSTUM_HPP
+
+#include <types.hpp>
+
+#include "glm/glm.hpp"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define MINECRAFTPP_FRUSTUM_SSE2
+#endif
+
+namespace minecraftpp {
+    // The six clip planes of a projection * view matrix. A point p is on the inner side of a plane
+    // when dot(plane.xyz, p) + plane.w >= 0. The planes are not normalised since culling only needs the sign.
+    struct Frustum {
+        std::array<glm::vec4, 6> planes;
+
+        // Planes are the sums and differences of the rows of the matrix (Gribb and Hartmann), in the
+        // order left, right, bottom, top, near, far. Assumes OpenGL clip space with z in [-w, w].
+        explicit Frustum(glm::mat4 const& projection_view) {
+            auto const row = [&](i32 const i) {
+                return glm::vec4(projection_view[0][i], projection_view[1][i], projection_view[2][i], projection_view[3][i]);
+            };
+
+            glm::vec4 const w = row(3);
+            for(i32 axis = 0; axis < 3; ++axis) {
+                glm::vec4 const r = row(axis);
+                planes[axis * 2] = glm::vec4(w.x + r.x, w.y + r.y, w.z + r.z, w.w + r.w);
+                planes[axis * 2 + 1] = glm::vec4(w.x - r.x, w.y - r.y, w.z - r.z, w.w - r.w);
+            }
+        }
+
+        // Whether the box with the given center and half extent is not entirely outside one of the planes.
+        // A box is outside a plane when its corner furthest along the plane normal is outside, which is
+        // dot(n, center) + dot(abs(n), extent) + w < 0.
+        bool intersects(glm::vec3 const center, glm::vec3 const extent) const {
+            for(glm::vec4 const& plane : planes) {
+                f32 const distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w +
+                                     std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+                if(distance < 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // Axis aligned boxes stored as separate arrays of centers and half extents, so that cull() can test
+    // four boxes against a plane with a handful of SIMD instructions.
+    class Aabb_List {
+    public:
+        void clear() {
+            center_x.clear();
+            center_y.clear();
+            center_z.clear();
+            extent_x.clear();
+            extent_y.clear();
+            extent_z.clear();
+        }
+
+        void push_back(glm::vec3 const min, glm::vec3 const max) {
+            center_x.push_back((min.x + max.x) * 0.5f);
+            center_y.push_back((min.y + max.y) * 0.5f);
+            center_z.push_back((min.z + max.z) * 0.5f);
+            extent_x.push_back((max.x - min.x) * 0.5f);
+            extent_y.push_back((max.y - min.y) * 0.5f);
+            extent_z.push_back((max.z - min.z) * 0.5f);
+        }
+
+        i64 size() const {
+            return center_x.size();
+        }
+
+        // Appends the indices of the boxes that are not entirely outside one of the planes to visible,
+        // in increasing order. Boxes near the corners of the frustum may be kept even though they are
+        // outside, which only costs a wasted draw.
+        void cull(Frustum const& frustum, std::vector<u32>& visible) const {
+            i64 const count = size();
+            i64 i = 0;
+#if defined(MINECRAFTPP_FRUSTUM_SSE2)
+            // Same test as Frustum::intersects() for four boxes at a time.
+            __m128 planes[6][7];
+            for(i32 p = 0; p < 6; ++p) {
+                glm::vec4 const plane = frustum.planes[p];
+                planes[p][0] = _mm_set1_ps(plane.x);
+                planes[p][1] = _mm_set1_ps(plane.y);
+                planes[p][2] = _mm_set1_ps(plane.z);
+                planes[p][3] = _mm_set1_ps(plane.w);
+                planes[p][4] = _mm_set1_ps(std::abs(plane.x));
+                planes[p][5] = _mm_set1_ps(std::abs(plane.y));
+                planes[p][6] = _mm_set1_ps(std::abs(plane.z));
+            }
+
+            for(; i + 4 <= count; i += 4) {
+                __m128 const cx = _mm_loadu_ps(&center_x[i]);
+                __m128 const cy = _mm_loadu_ps(&center_y[i]);
+                __m128 const cz = _mm_loadu_ps(&center_z[i]);
+                __m128 const ex = _mm_loadu_ps(&extent_x[i]);
+                __m128 const ey = _mm_loadu_ps(&extent_y[i]);
+                __m128 const ez = _mm_loadu_ps(&extent_z[i]);
+
+                __m128 outside = _mm_setzero_ps();
+                for(auto const& plane : planes) {
+                    __m128 distance = _mm_add_ps(_mm_mul_ps(plane[0], cx), plane[3]);
+                    distance = _mm_add_ps(distance, _mm_mul_ps(plane[1], cy));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(plane[2], cz));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(plane[4], ex));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(plane[5], ey));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(plane[6], ez));
+                    outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+                }
+
+                i32 const inside = ~_mm_movemask_ps(outside) & 0xF;
+                for(i32 lane = 0; lane < 4; ++lane) {
+                    if(inside & (1 << lane)) {
+                        visible.push_back(static_cast<u32>(i + lane));
+                    }
+                }
+            }
+#endif
+            for(; i < count; ++i) {
+                if(frustum.intersects({center_x[i], center_y[i], center_z[i]}, {extent_x[i], extent_y[i], extent_z[i]})) {
+                    visible.push_back(static_cast<u32>(i));
+                }
+            }
+        }
+
+    private:
+        std::vector<f32> center_x;
+        std::vector<f32> center_y;
+        std::vector<f32> center_z;
+        std::vector<f32> extent_x;
+        std::vector<f32> extent_y;
+        std::vector<f32> extent_z;
+    };
+}
+
+#endif // !MINECRAFTPP_FRUSTUM_HPP
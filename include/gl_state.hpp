@@ -0,0 +1,120 @@
+#ifndef MINECRAFTPP_GL_STATE_HPP
+#define MINECRAFTPP_GL_STATE_HPP
+
+#include <types.hpp>
+
+#include "glad/glad.h"
+
+#include <array>
+
+namespace minecraftpp {
+    // Shadow copy of the OpenGL bindings the renderer touches, so that binding what is already bound
+    // costs no driver call. Every binding has to go through this class for the copy to stay right, and
+    // code that binds behind its back has to call invalidate() afterwards. The ImGui backend restores
+    // all bindings it changes, so it does not need to.
+    //
+    // The element buffer is vertex array state and is attached once with glVertexArrayElementBuffer.
+    class Gl_State {
+    public:
+        static constexpr u32 max_indexed_bindings = 16;
+        static constexpr u32 max_texture_units = 32;
+
+        Gl_State() {
+            invalidate();
+        }
+
+        // Forgets all bindings, so that the next bind of each always reaches the driver.
+        void invalidate() {
+            program = unknown;
+            vertex_array = unknown;
+            draw_indirect_buffer = unknown;
+            storage_buffers.fill({unknown, 0, 0});
+            uniform_buffers.fill({unknown, 0, 0});
+            textures.fill(unknown);
+        }
+
+        void use_program(u32 const id) {
+            if(changed(program, id)) {
+                glUseProgram(id);
+            }
+        }
+
+        void bind_vertex_array(u32 const id) {
+            if(changed(vertex_array, id)) {
+                glBindVertexArray(id);
+            }
+        }
+
+        void bind_draw_indirect_buffer(u32 const buffer) {
+            if(changed(draw_indirect_buffer, buffer)) {
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+            }
+        }
+
+        // target is GL_SHADER_STORAGE_BUFFER or GL_UNIFORM_BUFFER. A size of 0 binds the whole buffer.
+        void bind_buffer_range(GLenum const target, u32 const index, u32 const buffer, i64 const offset = 0, i64 const size = 0) {
+            std::array<Indexed_Binding, max_indexed_bindings>& bindings =
+                target == GL_SHADER_STORAGE_BUFFER ? storage_buffers : uniform_buffers;
+            Indexed_Binding& binding = bindings[index];
+            if(binding.buffer == buffer && binding.offset == offset && binding.size == size) {
+                ++avoided;
+                return;
+            }
+
+            binding = {buffer, offset, size};
+            if(size == 0) {
+                glBindBufferBase(target, index, buffer);
+            } else {
+                glBindBufferRange(target, index, buffer, offset, size);
+            }
+        }
+
+        void bind_texture(u32 const unit, u32 const texture) {
+            if(changed(textures[unit], texture)) {
+                glBindTextureUnit(unit, texture);
+            }
+        }
+
+        // Starts counting the binds of a new frame.
+        void end_frame() {
+            avoided_last_frame = avoided;
+            avoided = 0;
+        }
+
+        // Binds skipped during the previous frame because the binding was already in place.
+        i64 get_avoided_changes() const {
+            return avoided_last_frame;
+        }
+
+    private:
+        // Never a valid object name, so the first bind of each binding always goes through.
+        static constexpr u32 unknown = 0xFFFFFFFF;
+
+        struct Indexed_Binding {
+            u32 buffer;
+            i64 offset;
+            i64 size;
+        };
+
+        u32 program;
+        u32 vertex_array;
+        u32 draw_indirect_buffer;
+        std::array<Indexed_Binding, max_indexed_bindings> storage_buffers;
+        std::array<Indexed_Binding, max_indexed_bindings> uniform_buffers;
+        std::array<u32, max_texture_units> textures;
+        i64 avoided = 0;
+        i64 avoided_last_frame = 0;
+
+        bool changed(u32& bound, u32 const id) {
+            if(bound == id) {
+                ++avoided;
+                return false;
+            }
+
+            bound = id;
+            return true;
+        }
+    };
+}
+
+#endif // !MINECRAFTPP_GL_STATE_HPP
@@ -0,0 +1,146 @@
+#ifndef MINECRAFTPP_MESH_BUFFER_HPP
+#define MINECRAFTPP_MESH_BUFFER_HPP
+
+#include <buffer_allocator.hpp>
+#include <chunk.hpp>
+#include <streaming_buffer.hpp>
+#include <types.hpp>
+
+#include "glad/glad.h"
+
+#include <iterator>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace minecraftpp {
+    // Layout of the commands read by glMultiDrawElementsIndirect.
+    struct Draw_Elements_Indirect_Command {
+        u32 count;
+        u32 instance_count;
+        u32 first_index;
+        i32 base_vertex;
+        u32 base_instance;
+    };
+
+    // GPU storage of all chunk meshes. The quads of every chunk live in one large buffer in a range
+    // that is sub-allocated when the chunk is meshed and stays put until the chunk is remeshed, so upload
+    // traffic follows the edits instead of the world size. compact() moves ranges from the end of the
+    // buffer into holes below them a few at a time, so fragmentation is cleaned up in the background.
+    //
+    // The quad buffer is not a vertex buffer. It is bound as a shader storage buffer and v_block.glsl reads
+    // quad gl_VertexID / 4 of it, so there are no vertex attributes. All chunks share one static index
+    // buffer holding the pattern 0, 1, 2, 2, 3, 0 offset by 4 per quad, which lets the post-transform
+    // cache reuse the shared corners. Each chunk draws it with 4 times its range offset as base vertex,
+    // which makes the draw of every chunk a single indirect command, see draw_command().
+    class Mesh_Buffer {
+    public:
+        // Largest number of exposed faces a chunk can have, reached by a checkerboard of blocks.
+        static constexpr i64 max_chunk_quads = 4096 / 2 * 6;
+
+        // capacity is in quads.
+        explicit Mesh_Buffer(i64 const capacity): allocator(capacity) {
+            // Only written by copies from the streaming buffer and by compaction, so no storage flags are needed.
+            glCreateBuffers(1, &quad_buffer);
+            glNamedBufferStorage(quad_buffer, capacity * sizeof(Quad), nullptr, 0);
+
+            std::vector<u32> indices;
+            indices.reserve(max_chunk_quads * 6);
+            for(u32 quad = 0; quad < max_chunk_quads; ++quad) {
+                for(u32 const index : {0, 1, 2, 2, 3, 0}) {
+                    indices.push_back(quad * 4 + index);
+                }
+            }
+            glCreateBuffers(1, &index_buffer);
+            glNamedBufferStorage(index_buffer, indices.size() * sizeof(u32), indices.data(), 0);
+        }
+
+        Mesh_Buffer(Mesh_Buffer const&) = delete;
+        Mesh_Buffer& operator=(Mesh_Buffer const&) = delete;
+
+        ~Mesh_Buffer() {
+            glDeleteBuffers(1, &quad_buffer);
+            glDeleteBuffers(1, &index_buffer);
+        }
+
+        // Moves the chunk's current mesh into the buffer. The chunk keeps its range when the quad count
+        // did not change. Returns false when the buffer has no room left, in which case the chunk has no range.
+        bool upload(Chunk& chunk, Streaming_Buffer& uploads) {
+            i64 const size = chunk.mesh.quads.size();
+            if(chunk.mesh_range.size != size) {
+                release(chunk);
+                if(size == 0) {
+                    return true;
+                }
+
+                std::optional<i64> const offset = allocator.allocate(size);
+                if(!offset) {
+                    return false;
+                }
+
+                chunk.mesh_range = {*offset, size};
+                owners.emplace(*offset, &chunk);
+            }
+
+            if(size != 0) {
+                uploads.upload(quad_buffer, chunk.mesh_range.offset * sizeof(Quad), chunk.mesh.quads.data(), size * sizeof(Quad));
+            }
+            return true;
+        }
+
+        void release(Chunk& chunk) {
+            if(chunk.mesh_range.size != 0) {
+                allocator.free(chunk.mesh_range);
+                owners.erase(chunk.mesh_range.offset);
+                chunk.mesh_range = {};
+            }
+        }
+
+        // Moves the ranges closest to the end of the buffer to the lowest free space below them, until
+        // max_quads quads were moved or the last range cannot move down anymore.
+        void compact(i64 const max_quads) {
+            i64 moved = 0;
+            while(moved < max_quads && !owners.empty()) {
+                auto const last = std::prev(owners.end());
+                Chunk& chunk = *last->second;
+                Buffer_Range const range = chunk.mesh_range;
+                std::optional<i64> const offset = allocator.allocate_below(range.size, range.offset);
+                if(!offset) {
+                    return;
+                }
+
+                glCopyNamedBufferSubData(quad_buffer, quad_buffer, range.offset * sizeof(Quad), *offset * sizeof(Quad), range.size * sizeof(Quad));
+                allocator.free(range);
+                owners.erase(last);
+                owners.emplace(*offset, &chunk);
+                chunk.mesh_range.offset = *offset;
+                moved += range.size;
+            }
+        }
+
+        static Draw_Elements_Indirect_Command draw_command(Chunk const& chunk) {
+            return {static_cast<u32>(chunk.mesh_range.size * 6), 1, 0, static_cast<i32>(chunk.mesh_range.offset * 4), 0};
+        }
+
+        u32 get_quad_buffer() const {
+            return quad_buffer;
+        }
+
+        u32 get_index_buffer() const {
+            return index_buffer;
+        }
+
+        Buffer_Allocator const& get_allocator() const {
+            return allocator;
+        }
+
+    private:
+        u32 quad_buffer = 0;
+        u32 index_buffer = 0;
+        Buffer_Allocator allocator;
+        // Chunks by the offset of their range, to find the ranges at the end of the buffer.
+        std::map<i64, Chunk*> owners;
+    };
+}
+
+#endif // !MINECRAFTPP_MESH_BUFFER_HPP
@@ -0,0 +1,100 @@
+#ifndef MINECRAFTPP_MESHER_HPP
+#define MINECRAFTPP_MESHER_HPP
+
+#include <chunk.hpp>
+#include <face_masks.hpp>
+#include <types.hpp>
+
+#include <array>
+#include <utility>
+
+namespace minecraftpp {
+    // Appends a w by h quad of the given block type lying in the plane of the given face. i and j are
+    // the quad's origin along the face's u and v axes. See v_block.glsl for the corners it expands to.
+    inline void emit_quad(Chunk_Mesh& mesh, Block_Type const block, Face const face, i32 const slice, i32 const i, i32 const j, i32 const w,
+                          i32 const h) {
+        i32 const axis = static_cast<i32>(face) / 2;
+        std::array<i32, 3> origin;
+        origin[axis] = slice;
+        origin[(axis + 1) % 3] = i;
+        origin[(axis + 2) % 3] = j;
+        mesh.quads.push_back(pack_quad(origin[0], origin[1], origin[2], w, h, face, face_texture(block, face)));
+    }
+
+    // Builds the geometry of all exposed block faces of a chunk. Faces on the chunk border are culled
+    // against the neighbouring chunks. Coplanar faces of the same block type are merged into rectangles,
+    // first along the u axis and then along the v axis of every slice.
+    template<typename Layout>
+    Chunk_Mesh build_mesh(Basic_Chunk_Neighbourhood<Layout> const& neighbourhood) {
+        Basic_Chunk<Layout> const& chunk = neighbourhood.chunk;
+        Chunk_Mesh mesh;
+        // A uniform chunk has no exposed faces in its interior. It is either all transparent, or only
+        // its outermost layer can be exposed, and only by the neighbours.
+        bool const uniform = chunk.is_uniform();
+        if(uniform && !is_opaque(chunk.block_at(0, 0, 0))) {
+            return mesh;
+        }
+
+        Face_Masks const face_masks = compute_face_masks(neighbourhood);
+        std::array<Block_Type, 256> mask;
+        for(i32 face = 0; face < 6; ++face) {
+            i32 const axis = face / 2;
+            i32 const u = (axis + 1) % 3;
+            i32 const v = (axis + 2) % 3;
+            i32 const border_slice = (face & 1) ? 15 : 0;
+            i32 const first_slice = uniform ? border_slice : 0;
+            i32 const last_slice = uniform ? border_slice : 15;
+            for(i32 slice = first_slice; slice <= last_slice; ++slice) {
+                for(i32 j = 0; j < 16; ++j) {
+                    for(i32 i = 0; i < 16; ++i) {
+                        std::array<i32, 3> p;
+                        p[axis] = slice;
+                        p[u] = i;
+                        p[v] = j;
+                        bool const exposed = face_masks.is_exposed(static_cast<Face>(face), p[0], p[1], p[2]);
+                        mask[j * 16 + i] = exposed ? chunk.block_at(p[0], p[1], p[2]) : Block_Type::air;
+                    }
+                }
+
+                for(i32 j = 0; j < 16; ++j) {
+                    for(i32 i = 0; i < 16;) {
+                        Block_Type const block = mask[j * 16 + i];
+                        if(block == Block_Type::air) {
+                            ++i;
+                            continue;
+                        }
+
+                        i32 w = 1;
+                        while(i + w < 16 && mask[j * 16 + i + w] == block) {
+                            ++w;
+                        }
+
+                        i32 h = 1;
+                        for(; j + h < 16; ++h) {
+                            bool row_matches = true;
+                            for(i32 k = 0; k < w && row_matches; ++k) {
+                                row_matches = mask[(j + h) * 16 + i + k] == block;
+                            }
+
+                            if(!row_matches) {
+                                break;
+                            }
+                        }
+
+                        emit_quad(mesh, block, static_cast<Face>(face), slice, i, j, w, h);
+                        for(i32 y = j; y < j + h; ++y) {
+                            for(i32 x = i; x < i + w; ++x) {
+                                mask[y * 16 + x] = Block_Type::air;
+                            }
+                        }
+                        i += w;
+                    }
+                }
+            }
+        }
+
+        return mesh;
+    }
+}
+
+#endif // !MINECRAFTPP_MESHER_HPP
@@ -0,0 +1,280 @@
+#ifndef MINECRAFTPP_OCCLUSION_HPP
+#define MINECRAFTPP_OCCLUSION_HPP
+
+#include <types.hpp>
+
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define MINECRAFTPP_OCCLUSION_SSE2
+#endif
+
+namespace minecraftpp {
+    // Low resolution depth buffer rasterised on the CPU, used to skip boxes hidden behind large occluders
+    // without reading anything back from the GPU. It does not touch OpenGL and runs headless.
+    //
+    // Each frame: begin() with the camera matrix, add the occluders, then query boxes with is_visible().
+    // The buffer keeps the nearest occluder depth per pixel, sampled at pixel centers, and a box is visible
+    // when any pixel it touches is not nearer than the nearest point of the box. Occluders are sampled at
+    // pixel centers, so a box showing only through the uncovered part of an edge pixel may be culled.
+    class Occlusion_Buffer {
+    public:
+        // width has to be a multiple of 4 so that rows can be processed four pixels at a time.
+        Occlusion_Buffer(i32 const width, i32 const height): width(width), height(height), depth(width * height, 1.0f) {
+            assert(width > 0 && width % 4 == 0 && height > 0);
+        }
+
+        // Clears the buffer and sets the matrix that takes world positions to clip space for this frame.
+        void begin(glm::mat4 const& projection_view) {
+            this->projection_view = projection_view;
+            std::fill(depth.begin(), depth.end(), 1.0f);
+        }
+
+        // Adds a planar convex quad with corners in order around its edge. Both windings are accepted.
+        void add_occluder(std::array<glm::vec3, 4> const& corners) {
+            std::array<glm::vec4, 4> clip;
+            for(i32 i = 0; i < 4; ++i) {
+                clip[i] = to_clip(corners[i]);
+            }
+
+            // Clipping a quad against the near plane leaves at most 5 vertices.
+            std::array<glm::vec4, 5> clipped;
+            i32 count = 0;
+            for(i32 i = 0; i < 4; ++i) {
+                glm::vec4 const a = clip[i];
+                glm::vec4 const b = clip[(i + 1) % 4];
+                f32 const da = a.z + a.w;
+                f32 const db = b.z + b.w;
+                if(da >= 0) {
+                    clipped[count++] = a;
+                }
+                if((da >= 0) != (db >= 0)) {
+                    f32 const t = da / (da - db);
+                    clipped[count++] = glm::vec4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t,
+                                                 a.w + (b.w - a.w) * t);
+                }
+            }
+            if(count < 3) {
+                return;
+            }
+
+            std::array<glm::vec3, 5> screen;
+            for(i32 i = 0; i < count; ++i) {
+                screen[i] = to_screen(clipped[i]);
+            }
+            rasterise_polygon(screen, count);
+        }
+
+        // Adds the faces in the bit mask faces (1 << Face) of the box [min, max] that face eye. Faces pointing away
+        // from eye are always behind the front faces of the box, so they would not change the buffer.
+        void add_box_occluder(glm::vec3 const min, glm::vec3 const max, u8 const faces, glm::vec3 const eye) {
+            for(i32 face = 0; face < 6; ++face) {
+                i32 const axis = face / 2;
+                bool const positive = face & 1;
+                if(!(faces & (1 << face)) || (positive ? eye[axis] <= max[axis] : eye[axis] >= min[axis])) {
+                    continue;
+                }
+
+                // The quad lies in the plane of the face and spans the two other axes.
+                i32 const u = (axis + 1) % 3;
+                i32 const v = (axis + 2) % 3;
+                std::array<glm::vec3, 4> corners;
+                for(i32 i = 0; i < 4; ++i) {
+                    corners[i][axis] = positive ? max[axis] : min[axis];
+                    corners[i][u] = (i == 1 || i == 2) ? max[u] : min[u];
+                    corners[i][v] = (i >= 2) ? max[v] : min[v];
+                }
+                add_occluder(corners);
+            }
+        }
+
+        // Whether any part of the box [min, max] might be visible past the occluders added since begin().
+        bool is_visible(glm::vec3 const min, glm::vec3 const max) const {
+            f32 min_x = f32(width), min_y = f32(height), max_x = 0, max_y = 0;
+            f32 nearest = 1.0f;
+            for(i32 i = 0; i < 8; ++i) {
+                glm::vec3 const corner{(i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z};
+                glm::vec4 const clip = to_clip(corner);
+                // Boxes reaching the near plane cannot be projected and are kept.
+                if(clip.z + clip.w <= 0 || clip.w <= 0) {
+                    return true;
+                }
+
+                glm::vec3 const point = to_screen(clip);
+                min_x = std::min(min_x, point.x);
+                min_y = std::min(min_y, point.y);
+                max_x = std::max(max_x, point.x);
+                max_y = std::max(max_y, point.y);
+                nearest = std::min(nearest, point.z);
+            }
+
+            i32 const x0 = pixel_floor(min_x, width);
+            i32 const y0 = pixel_floor(min_y, height);
+            i32 const x1 = pixel_ceil(max_x, width);
+            i32 const y1 = pixel_ceil(max_y, height);
+            for(i32 y = y0; y < y1; ++y) {
+                f32 const* const row = &depth[y * width];
+                i32 x = x0;
+#if defined(MINECRAFTPP_OCCLUSION_SSE2)
+                __m128 const box_depth = _mm_set1_ps(nearest);
+                for(; x + 4 <= x1; x += 4) {
+                    if(_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), box_depth)) != 0) {
+                        return true;
+                    }
+                }
+#endif
+                for(; x < x1; ++x) {
+                    if(row[x] >= nearest) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        i32 get_width() const {
+            return width;
+        }
+
+        i32 get_height() const {
+            return height;
+        }
+
+        // Depth in [0, 1] of the nearest occluder at the pixel, 1 where there is none.
+        f32 depth_at(i32 const x, i32 const y) const {
+            return depth[y * width + x];
+        }
+
+    private:
+        i32 width;
+        i32 height;
+        std::vector<f32> depth;
+        glm::mat4 projection_view{1.0f};
+
+        glm::vec4 to_clip(glm::vec3 const position) const {
+            return projection_view * glm::vec4(position.x, position.y, position.z, 1.0f);
+        }
+
+        // Pixel coordinates with y pointing up and depth mapped to [0, 1] like the default depth range.
+        glm::vec3 to_screen(glm::vec4 const clip) const {
+            f32 const inverse_w = 1.0f / clip.w;
+            return {(clip.x * inverse_w * 0.5f + 0.5f) * width, (clip.y * inverse_w * 0.5f + 0.5f) * height,
+                    clip.z * inverse_w * 0.5f + 0.5f};
+        }
+
+        // Pixel bounds clamped to [0, size] before the conversion, since vertices close to the near plane
+        // can land far outside the buffer.
+        static i32 pixel_floor(f32 const coordinate, i32 const size) {
+            return static_cast<i32>(std::clamp(std::floor(coordinate), 0.0f, f32(size)));
+        }
+
+        static i32 pixel_ceil(f32 const coordinate, i32 const size) {
+            return static_cast<i32>(std::clamp(std::ceil(coordinate), 0.0f, f32(size)));
+        }
+
+        // Rasterises the convex polygon as a whole rather than as a fan of triangles. Triangles sharing a diagonal
+        // evaluate it with different rounding, so a pixel center right on it could fall outside both and leave a
+        // hole in the middle of an occluder.
+        void rasterise_polygon(std::array<glm::vec3, 5> const& vertices, i32 const count) {
+            // Twice the signed area, and the fan triangle with the largest area to take the depth plane from,
+            // which stays accurate when clipping left a nearly degenerate corner.
+            f32 area = 0;
+            f32 plane_area = 0;
+            i32 plane_vertex = 2;
+            glm::vec3 const a = vertices[0];
+            for(i32 i = 2; i < count; ++i) {
+                glm::vec3 const b = vertices[i - 1];
+                glm::vec3 const c = vertices[i];
+                f32 const triangle_area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+                area += triangle_area;
+                if(std::abs(triangle_area) > std::abs(plane_area)) {
+                    plane_area = triangle_area;
+                    plane_vertex = i;
+                }
+            }
+            if(std::abs(area) < 1e-6f) {
+                return;
+            }
+
+            // Depth is linear in screen space after the perspective divide: z = zx * x + zy * y + z0.
+            glm::vec3 const b = vertices[plane_vertex - 1];
+            glm::vec3 const c = vertices[plane_vertex];
+            f32 const zx = ((b.z - a.z) * (c.y - a.y) - (c.z - a.z) * (b.y - a.y)) / plane_area;
+            f32 const zy = ((b.x - a.x) * (c.z - a.z) - (c.x - a.x) * (b.z - a.z)) / plane_area;
+            f32 const z0 = a.z - zx * a.x - zy * a.y;
+
+            // Edge functions are positive inside: e = ex * x + ey * y + e0. Clockwise polygons flip their sign.
+            f32 const winding = area > 0 ? 1.0f : -1.0f;
+            std::array<f32, 5> ex, ey, e0;
+            for(i32 i = 0; i < count; ++i) {
+                glm::vec3 const from = vertices[i];
+                glm::vec3 const to = vertices[(i + 1) % count];
+                ex[i] = (from.y - to.y) * winding;
+                ey[i] = (to.x - from.x) * winding;
+                e0[i] = -ex[i] * from.x - ey[i] * from.y;
+            }
+
+            f32 min_x = vertices[0].x, min_y = vertices[0].y, max_x = vertices[0].x, max_y = vertices[0].y;
+            for(i32 i = 1; i < count; ++i) {
+                min_x = std::min(min_x, vertices[i].x);
+                min_y = std::min(min_y, vertices[i].y);
+                max_x = std::max(max_x, vertices[i].x);
+                max_y = std::max(max_y, vertices[i].y);
+            }
+
+            // Pixel (x, y) is covered when its center (x + 0.5, y + 0.5) is inside.
+            i32 const x0 = pixel_floor(min_x, width) & ~3;
+            i32 const y0 = pixel_floor(min_y, height);
+            i32 const x1 = pixel_ceil(max_x, width);
+            i32 const y1 = pixel_ceil(max_y, height);
+            for(i32 y = y0; y < y1; ++y) {
+                f32 const center_y = y + 0.5f;
+                f32* const row = &depth[y * width];
+                i32 x = x0;
+#if defined(MINECRAFTPP_OCCLUSION_SSE2)
+                __m128 row_edge[5], step_edge[5];
+                for(i32 i = 0; i < count; ++i) {
+                    row_edge[i] = _mm_set1_ps(ey[i] * center_y + e0[i]);
+                    step_edge[i] = _mm_set1_ps(ex[i]);
+                }
+                __m128 const row_depth = _mm_set1_ps(zy * center_y + z0);
+                __m128 const step_depth = _mm_set1_ps(zx);
+                // x0 is rounded down to a multiple of 4 and width is one, so whole groups stay in the row.
+                for(; x < x1; x += 4) {
+                    __m128 const center_x = _mm_add_ps(_mm_set1_ps(f32(x)), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+                    __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(step_edge[0], center_x), row_edge[0]), _mm_setzero_ps());
+                    for(i32 i = 1; i < count; ++i) {
+                        inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(step_edge[i], center_x), row_edge[i]), _mm_setzero_ps()));
+                    }
+                    if(_mm_movemask_ps(inside) == 0) {
+                        continue;
+                    }
+
+                    __m128 const old_depth = _mm_loadu_ps(row + x);
+                    __m128 const new_depth = _mm_min_ps(old_depth, _mm_add_ps(_mm_mul_ps(step_depth, center_x), row_depth));
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_depth), _mm_andnot_ps(inside, old_depth)));
+                }
+#endif
+                for(; x < x1; ++x) {
+                    f32 const center_x = x + 0.5f;
+                    bool inside = true;
+                    for(i32 i = 0; i < count; ++i) {
+                        inside &= ex[i] * center_x + ey[i] * center_y + e0[i] >= 0;
+                    }
+                    if(inside) {
+                        row[x] = std::min(row[x], zx * center_x + zy * center_y + z0);
+                    }
+                }
+            }
+        }
+    };
+}
+
+#endif // !MINECRAFTPP_OCCLUSION_HPP
@@ -0,0 +1,116 @@
+#ifndef MINECRAFTPP_PROGRAM_CACHE_HPP
+#define MINECRAFTPP_PROGRAM_CACHE_HPP
+
+#include <cache_file.hpp>
+#include <types.hpp>
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Linked shader programs saved with glGetProgramBinary, so that later starts load them with glProgramBinary
+// instead of compiling and linking the sources again. Binaries only load on the driver that produced them,
+// which is why the driver strings are part of the key, and a driver may still reject one after an update
+// that left its strings alone. Callers build from source whenever loading fails.
+namespace minecraftpp {
+    inline constexpr char const* program_cache_directory = "cache/programs";
+
+    // Start of a program binary file, followed by length bytes of the binary.
+    struct Program_Binary_Header {
+        static constexpr u32 expected_magic = 0x4250434D; // "MCPB"
+        static constexpr u32 current_version = 1;
+
+        u32 magic;
+        u32 version;
+        u64 key;
+        // Driver-specific format reported by glGetProgramBinary.
+        u32 format;
+        u32 length;
+    };
+
+    // Identifies a program built from the sources of its stages, in stage order, on the current driver.
+    inline u64 program_cache_key(std::vector<std::string> const& sources) {
+        Fnv1a hash;
+        hash.mix(&Program_Binary_Header::current_version, sizeof(u32));
+        for(GLenum const name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION}) {
+            std::string const driver = reinterpret_cast<char const*>(glGetString(name));
+            u64 const size = driver.size();
+            hash.mix(&size, sizeof(size));
+            hash.mix(driver.data(), driver.size());
+        }
+        // The sizes keep the boundaries between stages apart.
+        for(std::string const& source : sources) {
+            u64 const size = source.size();
+            hash.mix(&size, sizeof(size));
+            hash.mix(source.data(), source.size());
+        }
+        return hash.get_hash();
+    }
+
+    inline std::filesystem::path program_cache_path(u64 const key) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", key);
+        return std::filesystem::path(program_cache_directory) / name;
+    }
+
+    // Loads the binary saved under key into program. Returns false when there is none, its format is not one
+    // the driver lists or the driver rejects it, in which case program can still be built from source as usual.
+    inline bool load_program_binary(u32 const program, u64 const key) {
+        std::ifstream input{program_cache_path(key), std::ios::binary};
+        Program_Binary_Header header;
+        if(!input.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != Program_Binary_Header::expected_magic ||
+           header.version != Program_Binary_Header::current_version || header.key != key || header.length == 0) {
+            return false;
+        }
+
+        std::vector<char> binary(header.length);
+        if(!input.read(binary.data(), binary.size())) {
+            return false;
+        }
+
+        // glProgramBinary raises a GL error for formats the driver does not know, which the debug callback treats
+        // as fatal, so binaries from another driver are skipped before they reach it.
+        i32 format_count = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+        std::vector<i32> formats(std::max(format_count, 0));
+        if(!formats.empty()) {
+            glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+        }
+        if(std::find(formats.begin(), formats.end(), static_cast<i32>(header.format)) == formats.end()) {
+            return false;
+        }
+
+        glProgramBinary(program, header.format, binary.data(), static_cast<i32>(binary.size()));
+        i32 status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        return status == GL_TRUE;
+    }
+
+    // Saves the binary of the linked program under key. Drivers without binary formats report an empty binary,
+    // which is not saved. Returns false on failure, which only costs the next start its head start.
+    inline bool save_program_binary(u32 const program, u64 const key) {
+        i32 length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if(length <= 0) {
+            return false;
+        }
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &length, &format, binary.data());
+        Program_Binary_Header const header{Program_Binary_Header::expected_magic, Program_Binary_Header::current_version, key, format,
+                                           static_cast<u32>(length)};
+
+        return write_file_atomically(program_cache_path(key), [&](std::ofstream& output) {
+            output.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            output.write(binary.data(), length);
+        });
+    }
+}
+
+#endif // !MINECRAFTPP_PROGRAM_CACHE_HPP
@@ -0,0 +1,124 @@
+#ifndef MINECRAFTPP_STREAMING_BUFFER_HPP
+#define MINECRAFTPP_STREAMING_BUFFER_HPP
+
+#include <types.hpp>
+
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+
+namespace minecraftpp {
+    // Upload path for data that changes between frames. A persistently and coherently mapped staging
+    // buffer is split into region_count regions used round robin. The CPU copies data straight into the
+    // mapped memory of the current region and the GPU moves it to its destination with
+    // glCopyNamedBufferSubData, so no upload ever waits on a buffer the GPU may still be reading from.
+    //
+    // Every region is guarded by a fence placed once the copies reading from it have been issued.
+    // A region is reused only after its fence signalled, which with the default of three regions
+    // normally happens without waiting.
+    class Streaming_Buffer {
+    public:
+        static constexpr i32 region_count = 3;
+
+        explicit Streaming_Buffer(i64 const region_size): region_size(region_size) {
+            GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glCreateBuffers(1, &buffer);
+            glNamedBufferStorage(buffer, region_size * region_count, nullptr, flags);
+            mapping = static_cast<u8*>(glMapNamedBufferRange(buffer, 0, region_size * region_count, flags));
+        }
+
+        Streaming_Buffer(Streaming_Buffer const&) = delete;
+        Streaming_Buffer& operator=(Streaming_Buffer const&) = delete;
+
+        ~Streaming_Buffer() {
+            for(GLsync const fence : fences) {
+                if(fence) {
+                    glDeleteSync(fence);
+                }
+            }
+            glUnmapNamedBuffer(buffer);
+            glDeleteBuffers(1, &buffer);
+        }
+
+        // Memory in the current region that the GPU can read from directly, e.g. as draw commands or
+        // shader storage, at offset into get_buffer().
+        struct Allocation {
+            u8* data;
+            i64 offset;
+        };
+
+        // Allocates size contiguous bytes. size must not exceed the region size and the region size
+        // must be a multiple of alignment.
+        Allocation allocate(i64 const size, i64 const alignment) {
+            assert(size <= region_size && region_size % alignment == 0);
+            i64 start = (offset + alignment - 1) / alignment * alignment;
+            if(start + size > region_size) {
+                advance();
+                start = 0;
+            }
+
+            offset = start + size;
+            i64 const staging_offset = region * region_size + start;
+            return {mapping + staging_offset, staging_offset};
+        }
+
+        u32 get_buffer() const {
+            return buffer;
+        }
+
+        // Copies size bytes of data to destination at destination_offset. Uploads larger than the space
+        // left in the current region continue in the next one.
+        void upload(u32 const destination, i64 destination_offset, void const* const data, i64 size) {
+            u8 const* source = static_cast<u8 const*>(data);
+            while(size > 0) {
+                if(offset == region_size) {
+                    advance();
+                }
+
+                i64 const count = std::min(size, region_size - offset);
+                i64 const staging_offset = region * region_size + offset;
+                std::memcpy(mapping + staging_offset, source, count);
+                glCopyNamedBufferSubData(buffer, destination, staging_offset, destination_offset, count);
+                // Keep the next staging offset 4-byte aligned so copies of vertex and index data stay fast.
+                offset = std::min(region_size, (offset + count + 3) & ~i64(3));
+                source += count;
+                destination_offset += count;
+                size -= count;
+            }
+        }
+
+        // Fences the current region and moves to the next one. Called once per frame after the last
+        // command that reads from the frame's allocations.
+        void advance() {
+            if(offset != 0) {
+                fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+
+            region = (region + 1) % region_count;
+            offset = 0;
+            if(GLsync const fence = fences[region]) {
+                while(true) {
+                    GLenum const status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+                    if(status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED || status == GL_WAIT_FAILED) {
+                        break;
+                    }
+                }
+                glDeleteSync(fence);
+                fences[region] = nullptr;
+            }
+        }
+
+    private:
+        u32 buffer = 0;
+        u8* mapping = nullptr;
+        i64 region_size;
+        i32 region = 0;
+        i64 offset = 0;
+        std::array<GLsync, region_count> fences{};
+    };
+}
+
+#endif // !MINECRAFTPP_STREAMING_BUFFER_HPP
@@ -0,0 +1,288 @@
+#ifndef MINECRAFTPP_TEXTURE_CACHE_HPP
+#define MINECRAFTPP_TEXTURE_CACHE_HPP
+
+#include <block_compression.hpp>
+#include <cache_file.hpp>
+#include <types.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace minecraftpp {
+    // Read-only memory mapping of a whole file. Empty when the file could not be mapped.
+    class Mapped_File {
+    public:
+        explicit Mapped_File(std::filesystem::path const& path) {
+#if defined(_WIN32)
+            file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            LARGE_INTEGER file_size;
+            if(file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+                return;
+            }
+
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(mapping) {
+                data = static_cast<u8 const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                size = data ? static_cast<usize>(file_size.QuadPart) : 0;
+            }
+#else
+            descriptor = open(path.c_str(), O_RDONLY);
+            struct stat status;
+            if(descriptor < 0 || fstat(descriptor, &status) != 0 || status.st_size == 0) {
+                return;
+            }
+
+            void* const address = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if(address != MAP_FAILED) {
+                data = static_cast<u8 const*>(address);
+                size = status.st_size;
+            }
+#endif
+        }
+
+        Mapped_File(Mapped_File&& other) noexcept {
+            swap(other);
+        }
+
+        Mapped_File& operator=(Mapped_File other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~Mapped_File() {
+#if defined(_WIN32)
+            if(data) {
+                UnmapViewOfFile(data);
+            }
+            if(mapping) {
+                CloseHandle(mapping);
+            }
+            if(file != INVALID_HANDLE_VALUE) {
+                CloseHandle(file);
+            }
+#else
+            if(data) {
+                munmap(const_cast<u8*>(data), size);
+            }
+            if(descriptor >= 0) {
+                close(descriptor);
+            }
+#endif
+        }
+
+        u8 const* get_data() const {
+            return data;
+        }
+
+        usize get_size() const {
+            return size;
+        }
+
+    private:
+        u8 const* data = nullptr;
+        usize size = 0;
+#if defined(_WIN32)
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#else
+        int descriptor = -1;
+#endif
+
+        void swap(Mapped_File& other) {
+            std::swap(data, other.data);
+            std::swap(size, other.size);
+#if defined(_WIN32)
+            std::swap(file, other.file);
+            std::swap(mapping, other.mapping);
+#else
+            std::swap(descriptor, other.descriptor);
+#endif
+        }
+    };
+
+    // Pixel formats a cooked texture can be stored in. The block-compressed ones store 4x4 texel blocks, and
+    // levels smaller than a block take a whole one.
+    enum class Cooked_Format : u32 {
+        rgba8,
+        bc1,
+        bc3,
+        bc7,
+    };
+
+    // Start of a cooked texture file. It is followed by every mip level from the largest down to 1x1,
+    // each holding all layers back to back, tightly packed and ready to be uploaded as they are.
+    struct Cooked_Texture_Header {
+        static constexpr u32 expected_magic = 0x5854434D; // "MCTX"
+        static constexpr u32 current_version = 1;
+
+        u32 magic;
+        u32 version;
+        // Identifies the source images the file was cooked from, see texture_source_stamp().
+        u64 source_stamp;
+        Cooked_Format format;
+        i32 size;
+        i32 level_count;
+        i32 layer_count;
+    };
+
+    // Bytes of one layer of a mip level.
+    inline usize cooked_level_bytes(Cooked_Format const format, i32 const size, i32 const level) {
+        usize const level_size = std::max(size >> level, 1);
+        if(format == Cooked_Format::rgba8) {
+            return level_size * level_size * 4;
+        }
+
+        usize const blocks_across = (level_size + 3) / 4;
+        return blocks_across * blocks_across * (format == Cooked_Format::bc1 ? 8 : 16);
+    }
+
+    // Hash of the paths, sizes and modification times of the source images of a cooked texture, so that a
+    // cooked file goes stale as soon as any of them changes. Missing files hash differently from any
+    // existing one, which makes the loader fall back to the sources and report the missing file there.
+    template<typename Paths>
+    u64 texture_source_stamp(Paths const& paths) {
+        Fnv1a hash;
+        hash.mix(&Cooked_Texture_Header::current_version, sizeof(u32));
+        for(auto const& path : paths) {
+            std::string const name = std::filesystem::path(path).generic_string();
+            hash.mix(name.data(), name.size());
+            std::error_code error;
+            u64 const file_size = std::filesystem::file_size(path, error);
+            i64 const write_time = error ? 0 : std::filesystem::last_write_time(path, error).time_since_epoch().count();
+            u64 const missing = error ? 1 : 0;
+            hash.mix(&file_size, sizeof(file_size));
+            hash.mix(&write_time, sizeof(write_time));
+            hash.mix(&missing, sizeof(missing));
+        }
+        return hash.get_hash();
+    }
+
+    // A cooked texture file mapped into memory.
+    class Cooked_Texture {
+    public:
+        // Maps the file at path. Returns nothing when it is missing, malformed or was cooked from other sources.
+        static std::optional<Cooked_Texture> open(std::filesystem::path const& path, u64 const source_stamp) {
+            Mapped_File file{path};
+            if(file.get_size() < sizeof(Cooked_Texture_Header)) {
+                return std::nullopt;
+            }
+
+            Cooked_Texture_Header header;
+            std::memcpy(&header, file.get_data(), sizeof(header));
+            if(header.magic != Cooked_Texture_Header::expected_magic || header.version != Cooked_Texture_Header::current_version ||
+               header.source_stamp != source_stamp || header.format > Cooked_Format::bc7 || header.size <= 0 ||
+               header.level_count != static_cast<i32>(std::bit_width(static_cast<u32>(header.size))) || header.layer_count <= 0) {
+                return std::nullopt;
+            }
+
+            Cooked_Texture texture{std::move(file), header};
+            usize offset = sizeof(Cooked_Texture_Header);
+            for(i32 level = 0; level < header.level_count; ++level) {
+                texture.level_offsets.push_back(offset);
+                offset += cooked_level_bytes(header.format, header.size, level) * header.layer_count;
+            }
+            if(offset != texture.file.get_size()) {
+                return std::nullopt;
+            }
+            return texture;
+        }
+
+        Cooked_Texture_Header const& get_header() const {
+            return header;
+        }
+
+        // All layers of the mip level, one after the other.
+        u8 const* level_data(i32 const level) const {
+            return file.get_data() + level_offsets[level];
+        }
+
+    private:
+        Mapped_File file;
+        Cooked_Texture_Header header;
+        std::vector<usize> level_offsets;
+
+        Cooked_Texture(Mapped_File file, Cooked_Texture_Header const& header): file(std::move(file)), header(header) {}
+    };
+
+    // Every mip level of a layer in its cooked format, from the largest down to 1x1.
+    using Cooked_Layer = std::vector<std::vector<u8>>;
+
+    // Builds the mip chain of a square RGBA8 image with a power of two size and converts every level to format.
+    // Levels are averaged from 2x2 texels of the level above. Meant to run on a worker, one layer per task.
+    inline Cooked_Layer cook_layer(Cooked_Format const format, std::vector<u8> image, i32 const size) {
+        Cooked_Layer levels;
+        for(i32 level_size = size;; level_size /= 2) {
+            switch(format) {
+                case Cooked_Format::rgba8:
+                    levels.emplace_back(image.begin(), image.begin() + static_cast<usize>(level_size) * level_size * 4);
+                    break;
+                case Cooked_Format::bc1:
+                    levels.push_back(compress_bc1(image.data(), level_size));
+                    break;
+                case Cooked_Format::bc3:
+                    levels.push_back(compress_bc3(image.data(), level_size));
+                    break;
+                case Cooked_Format::bc7:
+                    levels.push_back(compress_bc7(image.data(), level_size));
+                    break;
+            }
+            if(level_size == 1) {
+                return levels;
+            }
+
+            // Shrink the image in place. Every texel is written behind the ones still to be read.
+            i32 const next_size = level_size / 2;
+            for(i32 y = 0; y < next_size; ++y) {
+                for(i32 x = 0; x < next_size; ++x) {
+                    for(i32 channel = 0; channel < 4; ++channel) {
+                        auto const texel = [&](i32 const tx, i32 const ty) {
+                            return u32(image[((2 * y + ty) * level_size + 2 * x + tx) * 4 + channel]);
+                        };
+                        image[(y * next_size + x) * 4 + channel] = (texel(0, 0) + texel(1, 0) + texel(0, 1) + texel(1, 1) + 2) / 4;
+                    }
+                }
+            }
+        }
+    }
+
+    // Writes a cooked texture from layers made by cook_layer with write_file_atomically(). Returns false on failure.
+    inline bool write_cooked_texture(std::filesystem::path const& path, u64 const source_stamp, Cooked_Format const format, i32 const size,
+                                     std::vector<Cooked_Layer> const& layers) {
+        Cooked_Texture_Header const header{Cooked_Texture_Header::expected_magic, Cooked_Texture_Header::current_version, source_stamp,
+                                           format, size, static_cast<i32>(std::bit_width(static_cast<u32>(size))), static_cast<i32>(layers.size())};
+
+        return write_file_atomically(path, [&](std::ofstream& output) {
+            output.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            for(i32 level = 0; level < header.level_count; ++level) {
+                for(Cooked_Layer const& layer : layers) {
+                    output.write(reinterpret_cast<char const*>(layer[level].data()), layer[level].size());
+                }
+            }
+        });
+    }
+}
+
+#endif // !MINECRAFTPP_TEXTURE_CACHE_HPP
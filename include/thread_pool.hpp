@@ -0,0 +1,95 @@
+#ifndef MINECRAFTPP_THREAD_POOL_HPP
+#define MINECRAFTPP_THREAD_POOL_HPP
+
+#include <types.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace minecraftpp {
+    // Fixed set of worker threads running submitted tasks in submission order. Tasks must not touch
+    // OpenGL, whose context only lives on the main thread. The destructor runs the tasks still queued
+    // before joining the workers.
+    class Thread_Pool {
+    public:
+        // By default one thread per core, leaving one core to the main thread.
+        explicit Thread_Pool(u32 const thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1) {
+            for(u32 i = 0; i < thread_count; ++i) {
+                threads.emplace_back([this] {
+                    run_worker();
+                });
+            }
+        }
+
+        Thread_Pool(Thread_Pool const&) = delete;
+        Thread_Pool& operator=(Thread_Pool const&) = delete;
+
+        ~Thread_Pool() {
+            {
+                std::lock_guard const lock{mutex};
+                stopping = true;
+            }
+            wake.notify_all();
+            for(std::thread& thread : threads) {
+                thread.join();
+            }
+        }
+
+        // Queues task and returns a future for its result. Exceptions thrown by the task are rethrown by get().
+        template<typename F>
+        std::future<std::invoke_result_t<F>> submit(F&& task) {
+            // std::function has to be copyable, packaged_task is not.
+            auto const packaged = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(task));
+            auto result = packaged->get_future();
+            {
+                std::lock_guard const lock{mutex};
+                tasks.emplace_back([packaged] {
+                    (*packaged)();
+                });
+            }
+            wake.notify_one();
+            return result;
+        }
+
+        u32 get_thread_count() const {
+            return static_cast<u32>(threads.size());
+        }
+
+    private:
+        std::vector<std::thread> threads;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        void run_worker() {
+            while(true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock{mutex};
+                    wake.wait(lock, [this] {
+                        return stopping || !tasks.empty();
+                    });
+                    if(tasks.empty()) {
+                        return;
+                    }
+
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+    };
+}
+
+#endif // !MINECRAFTPP_THREAD_POOL_HPP
@@ -0,0 +1,87 @@
+#ifndef MINECRAFTPP_VISIBILITY_HPP
+#define MINECRAFTPP_VISIBILITY_HPP
+
+#include <chunk.hpp>
+#include <frustum.hpp>
+#include <types.hpp>
+#include <world.hpp>
+
+#include "glm/glm.hpp"
+
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+namespace minecraftpp {
+    struct Chunk_Coordinates_Hash {
+        usize operator()(glm::ivec3 const coordinates) const {
+            // Spatial hash from Teschner et al, see Column_Coordinates_Hash.
+            return (static_cast<u32>(coordinates.x) * 73856093u) ^ (static_cast<u32>(coordinates.y) * 19349663u) ^
+                   (static_cast<u32>(coordinates.z) * 83492791u);
+        }
+    };
+
+    // Finds the chunks that may be seen from the camera by walking the chunk grid breadth first from the
+    // camera chunk. A chunk entered through one face is only left through the faces its Face_Connections
+    // connect to it, so chunks sealed off by opaque blocks are never reached. The walk never steps against
+    // a direction it already took, which keeps it to paths a line of sight could follow, and never leaves
+    // the frustum, which bounds it. Coordinates without a loaded chunk are air and connect all their faces.
+    //
+    // Each chunk is only entered once, through the first face the walk reaches it by. This may miss a
+    // chunk that is only visible through another face, which is the usual trade-off of this search.
+    class Visibility_Search {
+    public:
+        // Replaces the contents of reachable with the loaded chunks reachable from eye.
+        void run(World const& world, glm::vec3 const eye, Frustum const& frustum, std::vector<Chunk const*>& reachable) {
+            reachable.clear();
+            visited.clear();
+            queue.clear();
+
+            glm::ivec3 const start = to_chunk_coordinates(eye);
+            visited.insert(start);
+            queue.push_back({start, -1, 0});
+            while(!queue.empty()) {
+                Step const step = queue.front();
+                queue.pop_front();
+
+                Chunk const* const chunk = world.find_chunk(step.coordinates);
+                if(chunk) {
+                    reachable.push_back(chunk);
+                }
+
+                for(i32 face = 0; face < 6; ++face) {
+                    i32 const opposite = face ^ 1;
+                    if(step.directions & (1 << opposite)) {
+                        continue;
+                    }
+                    if(chunk && step.entered >= 0 &&
+                       !chunk->face_connections.connects(static_cast<Face>(step.entered), static_cast<Face>(face))) {
+                        continue;
+                    }
+
+                    auto const [dx, dy, dz] = face_directions[face];
+                    glm::ivec3 const next{step.coordinates.x + dx, step.coordinates.y + dy, step.coordinates.z + dz};
+                    glm::vec3 const center = glm::vec3(next * 16) + 7.5f;
+                    if(!frustum.intersects(center, glm::vec3(8.0f)) || !visited.insert(next).second) {
+                        continue;
+                    }
+                    queue.push_back({next, opposite, static_cast<u8>(step.directions | 1 << face)});
+                }
+            }
+        }
+
+    private:
+        struct Step {
+            glm::ivec3 coordinates;
+            // Face of this chunk the walk came in through, -1 for the camera chunk.
+            i32 entered;
+            // Bit mask of the directions (1 << Face) taken so far.
+            u8 directions;
+        };
+
+        std::unordered_set<glm::ivec3, Chunk_Coordinates_Hash> visited;
+        std::deque<Step> queue;
+    };
+}
+
+#endif // !MINECRAFTPP_VISIBILITY_HPP
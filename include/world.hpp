@@ -0,0 +1,140 @@
+#ifndef MINECRAFTPP_WORLD_HPP
+#define MINECRAFTPP_WORLD_HPP
+
+#include <chunk.hpp>
+#include <column.hpp>
+#include <types.hpp>
+
+#include "glm/glm.hpp"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <deque>
+#include <unordered_map>
+
+namespace minecraftpp {
+    struct Column_Coordinates_Hash {
+        usize operator()(glm::ivec2 const coordinates) const {
+            // Spatial hash from Teschner et al. Done on unsigned values to keep overflow defined.
+            return (static_cast<u32>(coordinates.x) * 73856093u) ^ (static_cast<u32>(coordinates.y) * 83492791u);
+        }
+    };
+
+    // Converts world block coordinates to the coordinates of the containing chunk.
+    inline glm::ivec3 to_chunk_coordinates(i32 const x, i32 const y, i32 const z) {
+        // Arithmetic shift rounds towards negative infinity, so negative coordinates land in the right chunk.
+        return {x >> 4, y >> 4, z >> 4};
+    }
+
+    // Coordinates of the chunk containing a world position. Blocks are centered on their integer coordinates.
+    inline glm::ivec3 to_chunk_coordinates(glm::vec3 const position) {
+        return to_chunk_coordinates(static_cast<i32>(std::floor(position.x + 0.5f)), static_cast<i32>(std::floor(position.y + 0.5f)),
+                                    static_cast<i32>(std::floor(position.z + 0.5f)));
+    }
+
+    // Owns all loaded chunks. Chunks are stored in a deque so references stay valid and iteration
+    // order stays stable as chunks get loaded. Lookups by chunk coordinates go through a hash index
+    // of columns and then index the column's sections, so they cost the same for any number of chunks.
+    //
+    // The world spans y in [0, Column::height). Blocks outside of it read as air and writes are ignored.
+    class World {
+    public:
+        World() = default;
+        World(World const&) = delete;
+        World& operator=(World const&) = delete;
+
+        Column* find_column(glm::ivec2 const coordinates) {
+            auto const iter = columns.find(coordinates);
+            return iter != columns.end() ? &iter->second : nullptr;
+        }
+
+        Column const* find_column(glm::ivec2 const coordinates) const {
+            auto const iter = columns.find(coordinates);
+            return iter != columns.end() ? &iter->second : nullptr;
+        }
+
+        Chunk* find_chunk(glm::ivec3 const coordinates) {
+            Column* const column = find_column({coordinates.x, coordinates.z});
+            return column && in_height_range(coordinates.y) ? column->sections[coordinates.y] : nullptr;
+        }
+
+        Chunk const* find_chunk(glm::ivec3 const coordinates) const {
+            Column const* const column = find_column({coordinates.x, coordinates.z});
+            return column && in_height_range(coordinates.y) ? column->sections[coordinates.y] : nullptr;
+        }
+
+        // Returns the chunk at the given coordinates, creating an empty one if it is not loaded.
+        // coordinates.y must be a section of a column.
+        Chunk& load_chunk(glm::ivec3 const coordinates) {
+            assert(in_height_range(coordinates.y));
+            Chunk*& section = columns[{coordinates.x, coordinates.z}].sections[coordinates.y];
+            if(!section) {
+                section = &chunks.emplace_back();
+                section->coordinates = coordinates;
+            }
+            return *section;
+        }
+
+        // Neighbours of the chunk at the given coordinates indexed by Face. Unloaded neighbours are null.
+        std::array<Chunk*, 6> find_neighbours(glm::ivec3 const coordinates) {
+            std::array<Chunk*, 6> neighbours;
+            for(i32 face = 0; face < 6; ++face) {
+                auto const [dx, dy, dz] = face_directions[face];
+                neighbours[face] = find_chunk({coordinates.x + dx, coordinates.y + dy, coordinates.z + dz});
+            }
+            return neighbours;
+        }
+
+        // Blocks in unloaded chunks read as air.
+        Block_Type get_block(i32 const x, i32 const y, i32 const z) const {
+            Chunk const* const chunk = find_chunk(to_chunk_coordinates(x, y, z));
+            return chunk ? chunk->block_at(x & 15, y & 15, z & 15) : Block_Type::air;
+        }
+
+        // Loads the containing chunk if necessary.
+        void set_block(i32 const x, i32 const y, i32 const z, Block_Type const block) {
+            glm::ivec3 const coordinates = to_chunk_coordinates(x, y, z);
+            if(!in_height_range(coordinates.y)) {
+                return;
+            }
+
+            load_chunk(coordinates).set_block(x & 15, y & 15, z & 15, block);
+            columns[{coordinates.x, coordinates.z}].on_block_changed(x & 15, y, z & 15, block);
+        }
+
+        // Loads the chunk if necessary and makes all of its blocks the same.
+        void fill_chunk(glm::ivec3 const coordinates, Block_Type const block) {
+            if(!in_height_range(coordinates.y)) {
+                return;
+            }
+
+            load_chunk(coordinates).fill(block);
+            columns[{coordinates.x, coordinates.z}].on_section_filled(coordinates.y, block);
+        }
+
+        // World y of the highest opaque block at world x and z, or -1 when there is none.
+        i32 surface_height(i32 const x, i32 const z) const {
+            Column const* const column = find_column({x >> 4, z >> 4});
+            return column ? column->height_at(x & 15, z & 15) : -1;
+        }
+
+        std::deque<Chunk>& get_chunks() {
+            return chunks;
+        }
+
+        std::deque<Chunk> const& get_chunks() const {
+            return chunks;
+        }
+
+    private:
+        std::deque<Chunk> chunks;
+        std::unordered_map<glm::ivec2, Column, Column_Coordinates_Hash> columns;
+
+        static bool in_height_range(i32 const chunk_y) {
+            return chunk_y >= 0 && chunk_y < Column::section_count;
+        }
+    };
+}
+
+#endif // !MINECRAFTPP_WORLD_HPP
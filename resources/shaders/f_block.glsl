@@ -1,10 +1,26 @@
 #version 460 core
 
-uniform sampler2D sampler;
+// Per-frame render state, see Frame_Uniforms in frame_uniforms.hpp.
+layout (std140, binding = 0) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec4 camera_position;
+    vec4 fog_color;
+    float fog_start;
+    float fog_end;
+    float time;
+};
+
+// Block textures with one layer per Block_Texture, see block_textures.hpp.
+uniform sampler2DArray sampler;
 
 in vec2 tx_coords;
+flat in uint texture_layer;
+in float view_distance;
 out vec3 color;
 
 void main() {
-    color = texture(sampler, tx_coords).rgb;
-}
\ No newline at end of file
+    float fog = clamp((view_distance - fog_start) / (fog_end - fog_start), 0.0, 1.0);
+    color = mix(texture(sampler, vec3(tx_coords, texture_layer)).rgb, fog_color.rgb, fog);
+}
@@ -1,14 +1,67 @@
 #version 460 core
-layout (location = 0) in vec3 ivtx;
-layout (location = 1) in vec2 itx_coords;
-layout (location = 2) in vec3 offsets;
+// Chunk quads packed into 32 bits, see Quad in chunk.hpp. Every quad is drawn as 4 vertices through the
+// shared quad index buffer, so gl_VertexID / 4 is the quad and gl_VertexID % 4 the corner.
+layout (std430, binding = 1) readonly buffer Chunk_Quads {
+    uint quads[];
+};
 
-uniform mat4 pv_mat;
-uniform mat4 model;
+// Per-frame render state, see Frame_Uniforms in frame_uniforms.hpp.
+layout (std140, binding = 0) uniform Frame {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec4 camera_position;
+    vec4 fog_color;
+    float fog_start;
+    float fog_end;
+    float time;
+};
+// Coordinates of the chunk drawn by each command of the multi-draw.
+layout (std430, binding = 0) readonly buffer Chunk_Draws {
+    ivec4 chunk_coordinates[];
+};
 
 out vec2 tx_coords;
+flat out uint texture_layer;
+out float view_distance;
 
 void main() {
-    tx_coords = itx_coords;
-    gl_Position = pv_mat * model * vec4(ivtx.xyz + offsets.xyz, 1.0);
+    uint quad = quads[gl_VertexID >> 2];
+    uint corner = uint(gl_VertexID) & 3u;
+    uint face = (quad >> 20) & 7u;
+    texture_layer = quad >> 23;
+    uint axis = face / 2u;
+    bool positive = (face & 1u) == 1u;
+    // Corners go counter-clockwise around the face: (0, 0), (w, 0), (w, h), (0, h) along u and v for positive
+    // faces. u x v points along +axis, so negative faces swap corners 1 and 3 to keep the winding.
+    if (!positive && (corner & 1u) == 1u) {
+        corner ^= 2u;
+    }
+    float width = float(((quad >> 12) & 15u) + 1u);
+    float height = float(((quad >> 16) & 15u) + 1u);
+    vec2 corner_offset = vec2(corner == 1u || corner == 2u ? width : 0.0, corner >= 2u ? height : 0.0);
+
+    vec3 local = vec3(quad & 15u, (quad >> 4) & 15u, (quad >> 8) & 15u);
+    if (axis == 0u) {
+        local += vec3(positive ? 1.0 : 0.0, corner_offset);
+    } else if (axis == 1u) {
+        local += vec3(corner_offset.y, positive ? 1.0 : 0.0, corner_offset.x);
+    } else {
+        local += vec3(corner_offset, positive ? 1.0 : 0.0);
+    }
+
+    // Texture coordinates follow the position so that merged quads repeat the texture once per block.
+    // Side faces map t to -y to keep the texture upright.
+    if (axis == 0u) {
+        tx_coords = vec2(local.z, -local.y);
+    } else if (axis == 1u) {
+        tx_coords = local.xz;
+    } else {
+        tx_coords = vec2(local.x, -local.y);
+    }
+
+    // Blocks are centered on their integer coordinates.
+    vec3 position = vec3(chunk_coordinates[gl_DrawID].xyz * 16) + local - 0.5;
+    view_distance = distance(position, camera_position.xyz);
+    gl_Position = view_projection * vec4(position, 1.0);
 }
@@ -1,6 +1,19 @@
 #include "util.hpp"
 
-#include <vec3.hpp>
+#include <block_textures.hpp>
+#include <chunk.hpp>
+#include <draw_order.hpp>
+#include <frame_uniforms.hpp>
+#include <frustum.hpp>
+#include <gl_state.hpp>
+#include <mesh_buffer.hpp>
+#include <mesher.hpp>
+#include <occlusion.hpp>
+#include <program_cache.hpp>
+#include <streaming_buffer.hpp>
+#include <thread_pool.hpp>
+#include <visibility.hpp>
+#include <world.hpp>
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -17,6 +30,10 @@
 #include "glm/gtc/type_ptr.hpp"
 #include "fmt/format.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #if _MSC_VER
 	#define NO_MIN_MAX
 	#define WIN_LEAN_AND_MEAN
@@ -34,54 +51,83 @@ namespace minecraftpp {
 
 	class shader {
 		unsigned id = 0;
+		// Locations of the active uniforms by name, queried once after linking.
+		std::unordered_map<std::string, i32> uniform_locations;
 	public:
+		// Loads the linked program from the program cache when the sources and the driver are unchanged, and
+		// otherwise compiles and links the stages and saves the result there for the next start.
 		explicit shader(const std::filesystem::path& vshader, const std::filesystem::path& fshader, const std::filesystem::path& gshader = {}) {
-			std::ifstream f(vshader);
-			auto temp = std::string{ std::istreambuf_iterator<char>{ f }, {}};
-			auto source = temp.c_str();
-			auto vshaderi = glCreateShader(GL_VERTEX_SHADER);
-			auto fshaderi = glCreateShader(GL_FRAGMENT_SHADER);
-			auto gshaderi = 0u;
-			int success;
-			char ilog[512];
-			glShaderSource(vshaderi, 1, &source, nullptr);
-			glCompileShader(vshaderi);
-			glGetShaderiv(vshaderi, GL_COMPILE_STATUS, &success);
-			if (!success) {
-				glGetShaderInfoLog(vshaderi, 512, nullptr, ilog);
-				std::cout << "[Error] " << vshader << " shader compilation failed\n" << ilog;
-				throw std::runtime_error("shader compilation failed");
+			std::vector<std::filesystem::path> paths{ vshader, fshader };
+			if (!gshader.empty()) {
+				paths.push_back(gshader);
 			}
-			f.close();
-			f.open(fshader);
-			temp = std::string{ std::istreambuf_iterator<char>{ f }, {}};
-			source = temp.c_str();
-			glShaderSource(fshaderi, 1, &source, nullptr);
-			glCompileShader(fshaderi);
-			glGetShaderiv(fshaderi, GL_COMPILE_STATUS, &success);
-			if (!success) {
-				glGetShaderInfoLog(fshaderi, 512, nullptr, ilog);
-				std::cout << "[Error] " << fshader << " shader compilation failed\n" << ilog;
-				throw std::runtime_error("shader compilation failed");
+			std::vector<std::string> sources;
+			for (const auto& path : paths) {
+				std::ifstream f(path);
+				sources.emplace_back(std::istreambuf_iterator<char>{ f }, std::istreambuf_iterator<char>{});
 			}
+
 			id = glCreateProgram();
-			glAttachShader(id, vshaderi);
-			glAttachShader(id, fshaderi);
-			f.close();
-			if (!gshader.empty()) {
-				gshaderi = glCreateShader(GL_GEOMETRY_SHADER);
-				f.open(gshader);
-				temp = std::string{ std::istreambuf_iterator<char>{ f }, {}};
-				source = temp.c_str();
-				glShaderSource(gshaderi, 1, &source, nullptr);
-				glCompileShader(gshaderi);
-				glGetShaderiv(gshaderi, GL_COMPILE_STATUS, &success);
+			// Without the hint the driver does not have to keep the binary around after linking.
+			glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			auto const key = program_cache_key(sources);
+			if (!load_program_binary(id, key)) {
+				build(paths, sources);
+				save_program_binary(id, key);
+			}
+
+			i32 uniform_count = 0;
+			glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &uniform_count);
+			for (i32 i = 0; i < uniform_count; ++i) {
+				char name[256];
+				GLsizei length;
+				GLint size;
+				GLenum type;
+				glGetActiveUniform(id, i, sizeof(name), &length, &size, &type, name);
+				uniform_locations.emplace(std::string(name, length), glGetUniformLocation(id, name));
+			}
+		}
+		shader() = default;
+		shader(const shader& other) {
+			id = other.id;
+			uniform_locations = other.uniform_locations;
+		}
+		u32 get_id() const {
+			return id;
+		}
+		// -1 for names that are not active uniforms of the program, which the setters ignore.
+		i32 get_uniform_location(std::string const& name) const {
+			auto const iter = uniform_locations.find(name);
+			return iter != uniform_locations.end() ? iter->second : -1;
+		}
+		// The setters write to the program directly, so it does not have to be bound.
+		void set_int(i32 location, i32 value) const {
+			glProgramUniform1i(id, location, value);
+		}
+		void set_mat4(i32 location, glm::mat4 const& mat) const {
+			glProgramUniformMatrix4fv(id, location, 1, false, glm::value_ptr(mat));
+		}
+
+	private:
+		// Compiles the vertex, fragment and optional geometry stage in that order and links them into the program.
+		void build(const std::vector<std::filesystem::path>& paths, const std::vector<std::string>& sources) {
+			const GLenum stages[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+			std::vector<u32> shaders;
+			for (usize i = 0; i < sources.size(); ++i) {
+				auto shaderi = glCreateShader(stages[i]);
+				auto source = sources[i].c_str();
+				int success;
+				char ilog[512];
+				glShaderSource(shaderi, 1, &source, nullptr);
+				glCompileShader(shaderi);
+				glGetShaderiv(shaderi, GL_COMPILE_STATUS, &success);
 				if (!success) {
-					glGetShaderInfoLog(gshaderi, 512, nullptr, ilog);
-					std::cout << "[Error] " << gshader << " shader compilation failed\n" << ilog;
+					glGetShaderInfoLog(shaderi, 512, nullptr, ilog);
+					std::cout << "[Error] " << paths[i] << " shader compilation failed\n" << ilog;
 					throw std::runtime_error("shader compilation failed");
 				}
-				glAttachShader(id, gshaderi);
+				glAttachShader(id, shaderi);
+				shaders.push_back(shaderi);
 			}
 			glLinkProgram(id);
 			int linking_status = 0;
@@ -90,25 +136,10 @@ namespace minecraftpp {
 				std::string message = get_shader_linking_info(id);
 				throw std::runtime_error(std::move(message));
 			}
-			glDeleteShader(vshaderi);
-			glDeleteShader(fshaderi);
-			if (!gshader.empty()) {
-				glDeleteShader(gshaderi);
+			for (auto shaderi : shaders) {
+				glDeleteShader(shaderi);
 			}
 		}
-		shader() = default;
-		shader(const shader& other) {
-			id = other.id;
-		}
-		void use() const {
-			glUseProgram(id);
-		}
-		void set_mat4(const char* name, glm::mat4 mat) {
-			use();
-			glUniformMatrix4fv(glGetUniformLocation(id, name), 1, false, glm::value_ptr(mat));
-		}
-
-	private:
 		std::string get_shader_linking_info(u32 const program) {
 			i32 log_length;
 			glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
@@ -188,132 +219,6 @@ namespace minecraftpp {
 		}
 	} static cam{};
 
-	struct texture {
-		unsigned id;
-		texture() = default;
-		texture(const std::filesystem::path& path) {
-			glGenTextures(1, &id);
-			int pwidth, lheight, nr_components;
-			std::string const path_as_string = path.generic_string();
-			auto data = stbi_load(path_as_string.c_str(), &pwidth, &lheight, &nr_components, 0);
-			if (data) {
-				GLenum format = 0;
-				if (nr_components == 1) {
-					format = GL_RED;
-				} else if (nr_components == 3) {
-					format = GL_RGB;
-				} else if (nr_components == 4) {
-					format = GL_RGBA;
-				}
-				glBindTexture(GL_TEXTURE_2D, id);
-				glTexImage2D(GL_TEXTURE_2D, 0, format, pwidth, lheight, 0, format, GL_UNSIGNED_BYTE, data);
-				glGenerateMipmap(GL_TEXTURE_2D);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				stbi_image_free(data);
-			} else {
-				std::cout << fmt::format("Texture failed to load at path: {}", path.string());
-				assert(false);
-			}
-		}
-	};
-
-	struct Vertex {
-		glm::vec3 position;
-		glm::vec2 tex_coords;
-	};
-
-	enum class Block_Type {
-		air, dirt,
-	};
-
-	bool is_opaque(Block_Type const block) {
-		return block == Block_Type::dirt;
-	}
-
-	struct Chunk {
-		vec3 position;
-		std::array<Block_Type, 4096> blocks;
-
-		Chunk() = default;
-		explicit Chunk(std::array<Block_Type, 4096> blocks): blocks(blocks) {}
-
-		Block_Type block_at(i32 const x, i32 const y, i32 const z) const {
-			if(x < 0 || x > 15 || y < 0 || y > 15 || z < 0 || z > 15) {
-				return Block_Type::air;
-			} else {
-				return blocks[z * 256 + y * 16 + x];
-			}
-		}
-	};
-
-	std::vector<vec3> trim(Chunk const& chunk) {
-		std::vector<vec3> offsets;
-		for(i32 x = 0; x < 16; ++x) {
-			for(i32 y = 0; y < 16; ++y) {
-				for(i32 z = 0; z < 16; ++z) {
-					bool visible = is_opaque(chunk.block_at(x, y, z)) &&
-								   (!is_opaque(chunk.block_at(x - 1, y, z)) || !is_opaque(chunk.block_at(x + 1, y, z)) || 
-								   !is_opaque(chunk.block_at(x, y - 1, z)) || !is_opaque(chunk.block_at(x, y + 1, z)) || 
-								   !is_opaque(chunk.block_at(x, y, z - 1)) || !is_opaque(chunk.block_at(x, y, z + 1)));
-					if(visible) {
-						offsets.push_back(chunk.position + vec3(x, y, z));
-					}
-				}
-			}
-		}
-
-		return offsets;
-	}
-
-	std::array<Vertex, 36> generate_nonindexed_cube_geometry() {
-		return {
-			Vertex{{ -0.5f, -0.5f, -0.5f }, { 0.0f, 0.0f }},
-			Vertex{{ 0.5f, -0.5f, -0.5f }, { 1.0f, 0.0f }},
-			Vertex{{ 0.5f, 0.5f, -0.5f }, { 1.0f, 1.0f }},
-			Vertex{{ 0.5f, 0.5f, -0.5f }, { 1.0f, 1.0f }},
-			Vertex{{ -0.5f, 0.5f, -0.5f }, { 0.0f, 1.0f }},
-			Vertex{{ -0.5f, -0.5f, -0.5f }, { 0.0f, 0.0f }},
-
-			Vertex{{ -0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f }},
-			Vertex{{ 0.5f, -0.5f, 0.5f }, { 1.0f, 0.0f }},
-			Vertex{{ 0.5f, 0.5f, 0.5f }, { 1.0f, 1.0f }},
-			Vertex{{ 0.5f, 0.5f, 0.5f }, { 1.0f, 1.0f }},
-			Vertex{{ -0.5f, 0.5f, 0.5f }, { 0.0f, 1.0f }},
-			Vertex{{ -0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f }},
-
-			Vertex{{ -0.5f, 0.5f, 0.5f }, { 1.0f, 0.0f }},
-			Vertex{{ -0.5f, 0.5f, -0.5f }, { 1.0f, 1.0f }},
-			Vertex{{ -0.5f, -0.5f, -0.5f }, { 0.0f, 1.0f }},
-			Vertex{{ -0.5f, -0.5f, -0.5f }, { 0.0f, 1.0f }},
-			Vertex{{ -0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f }},
-			Vertex{{ -0.5f, 0.5f, 0.5f }, { 1.0f, 0.0f }},
-
-			Vertex{{ 0.5f, 0.5f, 0.5f }, { 1.0f, 0.0f }},
-			Vertex{{ 0.5f, 0.5f, -0.5f }, { 1.0f, 1.0f }},
-			Vertex{{ 0.5f, -0.5f, -0.5f }, { 0.0f, 1.0f }},
-			Vertex{{ 0.5f, -0.5f, -0.5f }, { 0.0f, 1.0f }},
-			Vertex{{ 0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f }},
-			Vertex{{ 0.5f, 0.5f, 0.5f }, { 1.0f, 0.0f }},
-
-			Vertex{{ -0.5f, -0.5f, -0.5f }, { 0.0f, 1.0f }},
-			Vertex{{ 0.5f, -0.5f, -0.5f }, { 1.0f, 1.0f }},
-			Vertex{{ 0.5f, -0.5f, 0.5f }, { 1.0f, 0.0f }},
-			Vertex{{ 0.5f, -0.5f, 0.5f }, { 1.0f, 0.0f }},
-			Vertex{{ -0.5f, -0.5f, 0.5f }, { 0.0f, 0.0f }},
-			Vertex{{ -0.5f, -0.5f, -0.5f }, { 0.0f, 1.0f }},
-
-			Vertex{{ -0.5f, 0.5f, -0.5f }, { 0.0f, 1.0f }},
-			Vertex{{ 0.5f, 0.5f, -0.5f }, { 1.0f, 1.0f }},
-			Vertex{{ 0.5f, 0.5f, 0.5f }, { 1.0f, 0.0f }},
-			Vertex{{ 0.5f, 0.5f, 0.5f }, { 1.0f, 0.0f }},
-			Vertex{{ -0.5f, 0.5f, 0.5f }, { 0.0f, 0.0f }},
-			Vertex{{ -0.5f, 0.5f, -0.5f }, { 0.0f, 1.0f }}
-		};
-	}
-
 	static void debug_callback(GLenum const source, GLenum const type, GLuint, GLenum const severity, GLsizei, GLchar const* const message, void const*) {
         auto stringify_source = [](GLenum const source) -> char const* {
             switch (source) {
@@ -389,8 +294,21 @@ namespace minecraftpp {
 	class application {
 		// Rendering
 		u32 vao;
-		u32 vbo;
-		i64 block_data_offset = -1;
+		Gl_State gl_state;
+		std::optional<Mesh_Buffer> meshes;
+		std::optional<Streaming_Buffer> uploads;
+		i64 storage_alignment = 0;
+		i64 uniform_alignment = 0;
+		// Set while chunks wait for room in the mesh buffer, so that the error is reported once.
+		bool mesh_buffer_full = false;
+
+		static constexpr i64 max_quads = 1048576;
+		static constexpr i64 upload_region_size = 4194304;
+		// Resolution of the CPU depth buffer used for occlusion culling.
+		static constexpr i32 occlusion_width = 256;
+		static constexpr i32 occlusion_height = 144;
+		// Quads moved by mesh buffer compaction per frame.
+		static constexpr i64 compaction_budget = 16384;
 
 		// Windowing
 		GLFWwindow* window;
@@ -464,26 +382,17 @@ namespace minecraftpp {
 			glEnable(GL_STENCIL_TEST);
 
 
-			glGenVertexArrays(1, &vao);
-			glBindVertexArray(vao);
-			glEnableVertexAttribArray(0);
-			glVertexAttribFormat(0, 3, GL_FLOAT, false, offsetof(Vertex, position));
-			glVertexAttribBinding(0, 0);
-			glEnableVertexAttribArray(1);
-			glVertexAttribFormat(1, 2, GL_FLOAT, false, offsetof(Vertex, tex_coords));
-			glVertexAttribBinding(1, 0);
-			glEnableVertexAttribArray(2);
-			glVertexAttribFormat(2, 3, GL_FLOAT, false, 0);
-			glVertexAttribBinding(2, 1);
-			glVertexBindingDivisor(1, 1);
-
-			glGenBuffers(1, &vbo);
-			glBindBuffer(GL_ARRAY_BUFFER, vbo);
-			i64 const buffer_size = 36 * sizeof(Vertex) + 4194304 * sizeof(vec3);
-			glBufferStorage(GL_ARRAY_BUFFER, buffer_size,nullptr, GL_DYNAMIC_STORAGE_BIT);
-			std::array<Vertex, 36> const cube_geom = generate_nonindexed_cube_geometry();
-			glBufferSubData(GL_ARRAY_BUFFER, 0, 36 * sizeof(Vertex), cube_geom.data());
-			block_data_offset = 36 * sizeof(Vertex);
+			// Chunk quads are pulled from a storage buffer by the vertex shader, so the vertex array
+			// has no attributes. It is still needed to draw and to hold the index buffer binding.
+			glCreateVertexArrays(1, &vao);
+			meshes.emplace(max_quads);
+			glVertexArrayElementBuffer(vao, meshes->get_index_buffer());
+			uploads.emplace(upload_region_size);
+			GLint alignment;
+			glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+			storage_alignment = alignment;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+			uniform_alignment = alignment;
 
 			init_imgui();
 			glfwSwapInterval(0);
@@ -502,18 +411,39 @@ namespace minecraftpp {
 				"shaders/f_block.glsl"
 			};
 			auto proj = glm::perspective(glm::radians(60.f), float(width) / float(height), 0.1f, 100.f);
-			s.use();
-			s.set_mat4("model", glm::mat4(1.0f));
-			std::vector<texture> tex_vec{
-				{ "textures/dirt.jpg" }
-			};
-
-			Chunk chunk0;
-			for(i32 i = 0; i < 4096; ++i) {
-				chunk0.blocks[i] = Block_Type::dirt;
+			s.set_int(s.get_uniform_location("sampler"), 0);
+			// Fog fades into the clear color and ends at the far plane.
+			glm::vec3 const sky_color{0.2f, 0.2f, 0.2f};
+			f32 const fog_start = 60.0f;
+			f32 const fog_end = 100.0f;
+			// Declared before everything that submits work to it, so that it is destroyed last.
+			Thread_Pool workers;
+			Block_Texture_Array block_textures{workers};
+
+			World world;
+			world.fill_chunk({0, 0, 0}, Block_Type::dirt);
+			for (i32 z = 0; z < 16; ++z) {
+				for (i32 x = 0; x < 16; ++x) {
+					world.set_block(x, 15, z, Block_Type::grass);
+				}
 			}
 
-			std::vector<Chunk> chunks{chunk0};
+			Draw_Order draw_order;
+			Visibility_Search visibility_search;
+			std::vector<Chunk const*> reachable_chunks;
+			std::vector<Chunk const*> drawable_chunks;
+			Aabb_List chunk_bounds;
+			std::vector<u32> visible_indices;
+			std::vector<Chunk const*> occluder_chunks;
+			Aabb_List occluder_bounds;
+			std::vector<u32> occluder_indices;
+			Occlusion_Buffer occlusion{occlusion_width, occlusion_height};
+			std::vector<Chunk const*> visible_chunks;
+			// Blocks are centered on their integer coordinates, so a chunk spans [min, min + 16].
+			auto const chunk_min = [](Chunk const& chunk) {
+				return glm::vec3(chunk.coordinates * 16) - 0.5f;
+			};
+
 			static int nframes = 0;
 			while (!glfwWindowShouldClose(window)) {
 				double current_frame = glfwGetTime();
@@ -524,27 +454,147 @@ namespace minecraftpp {
 				process_input();
 
 				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-				glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+				glClearColor(sky_color.x, sky_color.y, sky_color.z, 1.0f);
 
-				s.use();
-				s.set_mat4("pv_mat", proj * cam.get_view_mat());
+				glm::mat4 const view = cam.get_view_mat();
+				glm::mat4 const projection_view = proj * view;
 
 				{
-					glBindVertexArray(vao);
-					glBindBuffer(GL_ARRAY_BUFFER, vbo);
-					glBindVertexBuffer(0, vbo, 0, sizeof(Vertex));
-					glBindVertexBuffer(1, vbo, 36 * sizeof(Vertex), sizeof(vec3));
-
-					i64 offset = 0;
-					for (Chunk const& chunk : chunks) {
-						std::vector<vec3> trimmed_blocks = trim(chunk);
-						glBufferSubData(GL_ARRAY_BUFFER, offset + block_data_offset, trimmed_blocks.size() * sizeof(vec3), trimmed_blocks.data());
-						offset += trimmed_blocks.size() * sizeof(vec3);
+					gl_state.use_program(s.get_id());
+					gl_state.bind_vertex_array(vao);
+					gl_state.bind_buffer_range(GL_SHADER_STORAGE_BUFFER, 1, meshes->get_quad_buffer());
+
+					// Border changes have to reach the neighbours before meshing since their faces
+					// against the changed chunk may have become exposed or hidden.
+					for (Chunk& chunk : world.get_chunks()) {
+						if (chunk.dirty_borders == 0) {
+							continue;
+						}
+
+						std::array<Chunk*, 6> const neighbours = world.find_neighbours(chunk.coordinates);
+						for (i32 face = 0; face < 6; ++face) {
+							if (neighbours[face] && (chunk.dirty_borders & (1 << face))) {
+								neighbours[face]->dirty = true;
+							}
+						}
+						chunk.dirty_borders = 0;
 					}
 
-					glActiveTexture(GL_TEXTURE0);
-					glBindTexture(GL_TEXTURE_2D, tex_vec[0].id);
-					glDrawArraysInstanced(GL_TRIANGLES, 0, 36, offset / sizeof(vec3));
+					// Every chunk keeps its range in the mesh buffer, so only remeshed chunks are uploaded.
+					bool chunks_waiting = false;
+					for (Chunk& chunk : world.get_chunks()) {
+						if (!chunk.dirty) {
+							continue;
+						}
+
+						std::array<Chunk*, 6> const neighbours = world.find_neighbours(chunk.coordinates);
+						Chunk_Neighbourhood neighbourhood{chunk, {}};
+						std::copy(neighbours.begin(), neighbours.end(), neighbourhood.neighbours.begin());
+						chunk.mesh = build_mesh(neighbourhood);
+						chunk.opaque_borders = chunk.opaque_border_faces();
+						chunk.face_connections = chunk.compute_face_connections();
+						// A chunk that does not fit stays dirty and is retried next frame, once compaction
+						// or released chunks have made room.
+						if (meshes->upload(chunk, *uploads)) {
+							chunk.dirty = false;
+							continue;
+						}
+						if (!mesh_buffer_full && !chunks_waiting) {
+							std::cout << "[Error] chunk mesh buffer is full\n";
+						}
+						chunks_waiting = true;
+					}
+					mesh_buffer_full = chunks_waiting;
+					meshes->compact(compaction_budget);
+
+					// All chunks are drawn with one indirect call. The shader finds the coordinates of
+					// the chunk through gl_DrawID, so both arrays are written in the same order.
+					// Only chunks reachable from the camera chunk through transparent blocks can be seen.
+					// Of those, chunks outside the view frustum are skipped.
+					Frustum const frustum{projection_view};
+					visibility_search.run(world, cam.cam_pos, frustum, reachable_chunks);
+					drawable_chunks.clear();
+					chunk_bounds.clear();
+					for (Chunk const* const chunk : reachable_chunks) {
+						if (chunk->mesh_range.size != 0) {
+							glm::vec3 const min = chunk_min(*chunk);
+							drawable_chunks.push_back(chunk);
+							chunk_bounds.push_back(min, min + 16.0f);
+						}
+					}
+					occluder_chunks.clear();
+					occluder_bounds.clear();
+					for (Chunk const& chunk : world.get_chunks()) {
+						if (chunk.opaque_borders != 0) {
+							glm::vec3 const min = chunk_min(chunk);
+							occluder_chunks.push_back(&chunk);
+							occluder_bounds.push_back(min, min + 16.0f);
+						}
+					}
+					visible_indices.clear();
+					chunk_bounds.cull(frustum, visible_indices);
+					occluder_indices.clear();
+					occluder_bounds.cull(frustum, occluder_indices);
+
+					// The opaque border faces of chunks in view are rasterised on the CPU, and chunks hidden
+					// behind them are skipped as well.
+					occlusion.begin(projection_view);
+					for (u32 const index : occluder_indices) {
+						Chunk const& chunk = *occluder_chunks[index];
+						glm::vec3 const min = chunk_min(chunk);
+						occlusion.add_box_occluder(min, min + 16.0f, chunk.opaque_borders, cam.cam_pos);
+					}
+					visible_chunks.clear();
+					for (u32 const index : visible_indices) {
+						glm::vec3 const min = chunk_min(*drawable_chunks[index]);
+						if (occlusion.is_visible(min, min + 16.0f)) {
+							visible_chunks.push_back(drawable_chunks[index]);
+						}
+					}
+
+					// Chunks are drawn front to back so that early depth testing rejects hidden fragments.
+					draw_order.update(world.get_chunks(), to_chunk_coordinates(cam.cam_pos));
+					Draw_Order::sort(visible_chunks);
+
+					block_textures.update();
+					gl_state.bind_texture(0, block_textures.get_id());
+					if (!visible_chunks.empty()) {
+						i64 const draw_count = visible_chunks.size();
+						// The coordinates are bound as a storage buffer range, so they start at a multiple of its alignment.
+						i64 const uniforms_size = (i64(sizeof(Frame_Uniforms)) + storage_alignment - 1) / storage_alignment * storage_alignment;
+						i64 const coordinates_size = draw_count * sizeof(glm::ivec4);
+						i64 const commands_size = draw_count * sizeof(Draw_Elements_Indirect_Command);
+						// One allocation so that everything the draw reads stays in the region fenced after it.
+						Streaming_Buffer::Allocation const frame_data =
+							uploads->allocate(uniforms_size + coordinates_size + commands_size, std::max(uniform_alignment, storage_alignment));
+						i64 const coordinates_offset = frame_data.offset + uniforms_size;
+						i64 const commands_offset = coordinates_offset + coordinates_size;
+
+						Frame_Uniforms& uniforms = *reinterpret_cast<Frame_Uniforms*>(frame_data.data);
+						uniforms.view = view;
+						uniforms.projection = proj;
+						uniforms.view_projection = projection_view;
+						uniforms.camera_position = glm::vec4(cam.cam_pos, 1.0f);
+						uniforms.fog_color = glm::vec4(sky_color, 1.0f);
+						uniforms.fog_start = fog_start;
+						uniforms.fog_end = fog_end;
+						uniforms.time = static_cast<f32>(current_frame);
+
+						auto* const coordinates = reinterpret_cast<glm::ivec4*>(frame_data.data + uniforms_size);
+						auto* const commands = reinterpret_cast<Draw_Elements_Indirect_Command*>(frame_data.data + uniforms_size + coordinates_size);
+						for (i64 i = 0; i < draw_count; ++i) {
+							glm::ivec3 const chunk_coordinates = visible_chunks[i]->coordinates;
+							coordinates[i] = glm::ivec4(chunk_coordinates.x, chunk_coordinates.y, chunk_coordinates.z, 0);
+							commands[i] = Mesh_Buffer::draw_command(*visible_chunks[i]);
+						}
+
+						gl_state.bind_buffer_range(GL_UNIFORM_BUFFER, frame_uniforms_binding, uploads->get_buffer(), frame_data.offset,
+												   sizeof(Frame_Uniforms));
+						gl_state.bind_buffer_range(GL_SHADER_STORAGE_BUFFER, 0, uploads->get_buffer(), coordinates_offset, coordinates_size);
+						gl_state.bind_draw_indirect_buffer(uploads->get_buffer());
+						glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void const*>(commands_offset), draw_count, 0);
+					}
+					uploads->advance();
 				}
 
 				ImGui_ImplOpenGL3_NewFrame();
@@ -558,10 +608,22 @@ namespace minecraftpp {
 					1 / delta_time, delta_time, nframes,
 					cam.cam_pos.x, cam.cam_pos.y, cam.cam_pos.z,
 					cam.has_moved() ? "true" : "false");
+				usize block_memory = 0;
+				for (Chunk const& chunk : world.get_chunks()) {
+					block_memory += chunk.memory_usage();
+				}
+				ImGui::Text("drawn chunks: %zu, reachable: %zu, in frustum: %zu", visible_chunks.size(), drawable_chunks.size(),
+							visible_indices.size());
+				ImGui::Text("chunks: %zu, block memory: %.1f KiB", world.get_chunks().size(), block_memory / 1024.0);
+				Buffer_Allocator const& mesh_allocator = meshes->get_allocator();
+				ImGui::Text("mesh buffer: %lld / %lld quads, %lld free blocks", mesh_allocator.get_used(), mesh_allocator.get_capacity(),
+							mesh_allocator.get_free_block_count());
+				ImGui::Text("avoided state changes: %lld", gl_state.get_avoided_changes());
 				ImGui::End();
 				ImGui::Render();
 				ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 				glfwSwapBuffers(window);
+				gl_state.end_frame();
 				++nframes;
 			}
 
@@ -0,0 +1,104 @@
+// Compares compute_face_masks with the per-block neighbour test it replaced, on random chunks and
+// neighbourhoods. Covers whichever of the AVX2, SSE2 and scalar paths the test is compiled for.
+// Build with -DMINECRAFTPP_BUILD_TESTS=ON and run ctest.
+
+#include <chunk.hpp>
+#include <chunk_layout.hpp>
+#include <face_masks.hpp>
+#include <types.hpp>
+
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <random>
+
+namespace minecraftpp {
+    i32 failures = 0;
+
+    // Fills chunk in one of the ways the palette storage treats differently.
+    template<typename Layout>
+    void randomise(Basic_Chunk<Layout>& chunk, std::mt19937& random) {
+        i32 const kind = random() % 5;
+        if(kind == 0) {
+            chunk.fill(random() % 2 ? Block_Type::dirt : Block_Type::air);
+            return;
+        }
+
+        // Air and one block type, air and two, or a single block changed in a uniform chunk.
+        u32 const density = random() % 100;
+        chunk.fill(Block_Type::air);
+        if(kind == 3) {
+            chunk.fill(Block_Type::dirt);
+            chunk.set_block(random() % 16, random() % 16, random() % 16, Block_Type::air);
+            return;
+        }
+        for(i32 z = 0; z < 16; ++z) {
+            for(i32 y = 0; y < 16; ++y) {
+                for(i32 x = 0; x < 16; ++x) {
+                    if(random() % 100 < density) {
+                        chunk.set_block(x, y, z, kind == 2 && random() % 2 ? Block_Type::grass : Block_Type::dirt);
+                    }
+                }
+            }
+        }
+    }
+
+    template<typename Layout>
+    void compare_with_neighbour_test(char const* const layout_name) {
+        std::mt19937 random{7};
+        auto const chunk = std::make_unique<Basic_Chunk<Layout>>();
+        std::array<std::unique_ptr<Basic_Chunk<Layout>>, 6> neighbours;
+        for(auto& neighbour : neighbours) {
+            neighbour = std::make_unique<Basic_Chunk<Layout>>();
+        }
+
+        i32 mismatches = 0;
+        for(i32 iteration = 0; iteration < 500; ++iteration) {
+            randomise(*chunk, random);
+            Basic_Chunk_Neighbourhood<Layout> neighbourhood{*chunk, {}};
+            for(i32 face = 0; face < 6; ++face) {
+                // Some neighbours are missing, which reads as air.
+                if(random() % 4 != 0) {
+                    randomise(*neighbours[face], random);
+                    neighbourhood.neighbours[face] = neighbours[face].get();
+                }
+            }
+
+            Face_Masks const masks = compute_face_masks(neighbourhood);
+            for(i32 face = 0; face < 6; ++face) {
+                auto const [dx, dy, dz] = face_directions[face];
+                for(i32 z = 0; z < 16; ++z) {
+                    for(i32 y = 0; y < 16; ++y) {
+                        for(i32 x = 0; x < 16; ++x) {
+                            bool const expected = is_opaque(neighbourhood.block_at(x, y, z)) && !is_opaque(neighbourhood.block_at(x + dx, y + dy, z + dz));
+                            if(masks.is_exposed(static_cast<Face>(face), x, y, z) != expected) {
+                                if(mismatches++ < 10) {
+                                    std::printf("FAILED: %s layout, iteration %d, face %d at (%d, %d, %d)\n", layout_name, iteration, face, x, y, z);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        failures += mismatches;
+    }
+}
+
+int main() {
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    if(!__builtin_cpu_supports("avx2")) {
+        std::printf("skipped: the CPU does not support AVX2\n");
+        return 77;
+    }
+#endif
+
+    minecraftpp::compare_with_neighbour_test<minecraftpp::Linear_Layout>("linear");
+    minecraftpp::compare_with_neighbour_test<minecraftpp::Morton_Layout>("morton");
+    if(minecraftpp::failures != 0) {
+        return 1;
+    }
+
+    std::printf("face masks match the neighbour test\n");
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Checks of the CPU occlusion buffer that run without a window or OpenGL context.
+// Build with -DMINECRAFTPP_BUILD_TESTS=ON and run ctest.
+
+#include <occlusion.hpp>
+#include <types.hpp>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <array>
+#include <cstdio>
+
+namespace minecraftpp {
+    i32 failures = 0;
+
+    void check(bool const condition, char const* const description) {
+        if(!condition) {
+            std::printf("FAILED: %s\n", description);
+            ++failures;
+        }
+    }
+
+    glm::mat4 camera_matrix(glm::vec3 const eye, glm::vec3 const direction) {
+        return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) * glm::lookAt(eye, eye + direction, glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    // A wall covering the whole screen has to hide every box behind it, including boxes centered on screen.
+    // The sweep over camera positions makes pixel centers land exactly on the diagonal of the wall.
+    void full_screen_occluder_hides_box_behind() {
+        Occlusion_Buffer buffer{256, 144};
+        i32 uncovered = 0;
+        i32 visible_behind = 0;
+        for(i32 step = 0; step < 2000; ++step) {
+            glm::vec3 const eye{(step % 20) * 0.05f - 0.5f, (step / 20 % 10) * 0.1f - 0.5f, (step / 200) * 0.1f};
+            glm::vec3 const direction{(step % 7) * 0.05f - 0.15f, (step % 5) * 0.05f - 0.1f, -1.0f};
+            buffer.begin(camera_matrix(eye, direction));
+            buffer.add_occluder({glm::vec3(-40.0f, -45.0f, -10.0f), glm::vec3(40.0f, -40.0f, -10.0f), glm::vec3(44.0f, 40.0f, -10.0f),
+                                 glm::vec3(-40.0f, 40.0f, -10.0f)});
+
+            for(i32 y = 0; y < buffer.get_height(); ++y) {
+                for(i32 x = 0; x < buffer.get_width(); ++x) {
+                    uncovered += buffer.depth_at(x, y) >= 1.0f;
+                }
+            }
+            glm::vec3 const center = eye + direction * 20.0f;
+            visible_behind += buffer.is_visible(center - glm::vec3(0.5f), center + glm::vec3(0.5f));
+        }
+        check(uncovered == 0, "full-screen occluder covers every pixel");
+        check(visible_behind == 0, "box centered on screen behind the occluder is culled");
+
+        buffer.begin(camera_matrix(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f)));
+        buffer.add_occluder({glm::vec3(-40.0f, -40.0f, -10.0f), glm::vec3(40.0f, -40.0f, -10.0f), glm::vec3(40.0f, 40.0f, -10.0f),
+                             glm::vec3(-40.0f, 40.0f, -10.0f)});
+        check(buffer.is_visible({-0.5f, -0.5f, -5.5f}, {0.5f, 0.5f, -4.5f}), "box in front of the occluder is visible");
+    }
+
+    // Box occluders are added face by face, so the same has to hold for the front face of a box.
+    void box_occluder_hides_box_behind() {
+        Occlusion_Buffer buffer{256, 144};
+        buffer.begin(camera_matrix(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f)));
+        buffer.add_box_occluder({-100.0f, -100.0f, -12.0f}, {100.0f, 100.0f, -10.0f}, 0x3F, glm::vec3(0.0f));
+        check(!buffer.is_visible({-0.5f, -0.5f, -20.5f}, {0.5f, 0.5f, -19.5f}), "box behind a box occluder is culled");
+        check(buffer.is_visible({-0.5f, -0.5f, -11.5f}, {0.5f, 0.5f, -8.5f}), "box straddling the occluder is visible");
+    }
+}
+
+int main() {
+    minecraftpp::full_screen_occluder_hides_box_behind();
+    minecraftpp::box_occluder_hides_box_behind();
+    if(minecraftpp::failures != 0) {
+        return 1;
+    }
+
+    std::printf("all occlusion checks passed\n");
+    return 0;
+}